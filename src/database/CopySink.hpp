@@ -0,0 +1,181 @@
+#pragma once
+
+// ============================================================================
+// CopySink — Pluggable destination for an encoded COPY stream
+// ============================================================================
+//
+// WHY?
+// A COPY into PostgreSQL costs three things at once:
+//   encode  — Trade → "1001\t5001\t...\n"          (our CPU)
+//   send    — bytes through libpq and the socket   (kernel + network)
+//   ingest  — parse, heap insert, WAL              (the server)
+// Timing it against a live database measures all three together, and only
+// where a database exists. Swapping the destination isolates each part:
+//
+//   NullCopySink  — discards the bytes        → pure encoding ceiling
+//   FileCopySink  — writes them to a file     → encoding + write(2); the file
+//                                               loads later via psql \copy
+//   PgCopySink    — COPY FROM STDIN on libpq  → a real server, or
+//                                               PgWireStandIn (tools/) for the
+//                                               client + socket cost only
+//
+// stream_to_sink() runs the SAME block-encoding loop for every sink, so the
+// numbers differ only by what the sink does with a block.
+// ============================================================================
+
+#include <string>
+#include <string_view>
+#include <span>
+#include <fstream>
+#include <chrono>
+#include <stdexcept>
+#include <algorithm> // std::count — rows = '\n' count
+#include "CopyStream.hpp"
+#include "../model/Trade.hpp"
+
+namespace MarketStream
+{
+
+    class CopySink
+    {
+    public:
+        virtual ~CopySink() = default;
+
+        // copy_sql: the full "COPY table (cols) FROM STDIN" statement
+        virtual void begin(const std::string &copy_sql) = 0;
+
+        // One block of complete COPY text rows
+        virtual void write(std::string_view block) = 0;
+
+        // End of data; returns rows accepted
+        virtual long long end() = 0;
+
+        [[nodiscard]] virtual const char *name() const = 0;
+    };
+
+    // ============================================================================
+    // NullCopySink — /dev/null: counts rows, keeps nothing
+    // ============================================================================
+    class NullCopySink : public CopySink
+    {
+    public:
+        void begin(const std::string &) override { rows_ = 0; }
+
+        void write(std::string_view block) override
+        {
+            // Touch the bytes once so the encoder cannot be optimized away
+            rows_ += std::count(block.begin(), block.end(), '\n');
+        }
+
+        long long end() override { return rows_; }
+        const char *name() const override { return "null"; }
+
+    private:
+        long long rows_ = 0;
+    };
+
+    // ============================================================================
+    // FileCopySink — COPY text to a file (one file per sink)
+    // ============================================================================
+    class FileCopySink : public CopySink
+    {
+    public:
+        explicit FileCopySink(std::string path) : path_(std::move(path)) {}
+
+        void begin(const std::string &) override
+        {
+            out_.open(path_, std::ios::binary | std::ios::trunc);
+            if (!out_)
+                throw std::runtime_error("[COPY] Cannot open sink file: " + path_);
+            rows_ = 0;
+        }
+
+        void write(std::string_view block) override
+        {
+            out_.write(block.data(), static_cast<std::streamsize>(block.size()));
+            rows_ += std::count(block.begin(), block.end(), '\n');
+        }
+
+        long long end() override
+        {
+            out_.close();
+            if (out_.fail())
+                throw std::runtime_error("[COPY] Write failed: " + path_);
+            return rows_;
+        }
+
+        const char *name() const override { return "file"; }
+
+    private:
+        std::string path_;
+        std::ofstream out_;
+        long long rows_ = 0;
+    };
+
+    // ============================================================================
+    // PgCopySink — COPY FROM STDIN in its own transaction (blocking libpq)
+    // ============================================================================
+    class PgCopySink : public CopySink
+    {
+    public:
+        explicit PgCopySink(const std::string &conn_str) : stream_(conn_str) {}
+
+        void begin(const std::string &copy_sql) override
+        {
+            stream_.exec("BEGIN");
+            stream_.begin_copy(copy_sql);
+        }
+
+        void write(std::string_view block) override { stream_.put(block); }
+
+        long long end() override
+        {
+            const long long rows = stream_.end_copy();
+            stream_.exec("COMMIT");
+            return rows;
+        }
+
+        const char *name() const override { return "postgres"; }
+
+    private:
+        PgCopyStream stream_;
+    };
+
+    // ============================================================================
+    // stream_to_sink() — encode rows in ~256 KB blocks into any sink
+    // ============================================================================
+    inline CopyStreamStats stream_to_sink(CopySink &sink, std::span<const Trade> rows,
+                                          const std::string &table = "trades",
+                                          size_t block_bytes = AsyncCopyWriter::DEFAULT_BLOCK)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+
+        std::string block;
+        block.reserve(block_bytes + 512);
+        CopyStreamStats stats;
+
+        sink.begin("COPY " + table + " " + CopyRowEncoder::COLUMNS + " FROM STDIN");
+        for (const auto &t : rows)
+        {
+            CopyRowEncoder::append(block, t);
+            if (block.size() >= block_bytes)
+            {
+                sink.write(block);
+                stats.bytes += static_cast<long long>(block.size());
+                block.clear();
+            }
+        }
+        if (!block.empty())
+        {
+            sink.write(block);
+            stats.bytes += static_cast<long long>(block.size());
+        }
+        stats.rows = sink.end();
+
+        stats.total_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - t0)
+                             .count();
+        return stats;
+    }
+
+} // namespace MarketStream
@@ -0,0 +1,457 @@
+// =============================================================================
+// CopyStream.cpp — libpq COPY stream + COPY text encoding / binary decoding
+// =============================================================================
+
+#include "CopyStream.hpp"
+#include <charconv>  // std::to_chars — locale-free number formatting
+#include <stdexcept>
+#include <cstdlib>   // std::strtoll — PQcmdTuples() returns text
+#include <cstring>   // std::memcpy, std::memcmp — binary COPY fields
+#include <cerrno>
+
+#ifdef _WIN32
+#include <winsock2.h> // WSAPoll — same pollfd / POLLIN / POLLOUT as POSIX
+static int poll(pollfd* fds, unsigned long n, int timeout_ms) { return WSAPoll(fds, n, timeout_ms); }
+#else
+#include <poll.h>     // poll() — wait for the COPY socket
+#endif
+
+namespace MarketStream
+{
+
+// =============================================================================
+// CopyRowEncoder
+// =============================================================================
+// WHY to_chars INTO A RESERVED BUFFER?
+//   The row is built in place at the end of `buf`: grow by the worst case
+//   (~160 bytes + symbol), write with to_chars, then trim to what was used.
+//   No temporary std::string per field, no ostringstream, no locale lookups.
+// =============================================================================
+void CopyRowEncoder::append(std::string& buf, const Trade& t)
+{
+    constexpr size_t MAX_NUMERIC = 4 * 21 + 32 + 16;  // 4 integers, 1 double, separators
+
+    const size_t start = buf.size();
+    buf.resize(start + MAX_NUMERIC);
+    char* p = buf.data() + start;
+    char* end = buf.data() + buf.size();
+
+    p = std::to_chars(p, end, t.trade_id).ptr;   *p++ = '\t';
+    p = std::to_chars(p, end, t.order_id).ptr;   *p++ = '\t';
+    p = std::to_chars(p, end, t.timestamp).ptr;  *p++ = '\t';
+    buf.resize(static_cast<size_t>(p - buf.data()));
+
+    append_text(buf, t.symbol);
+
+    const size_t mid = buf.size();
+    buf.resize(mid + MAX_NUMERIC);
+    p = buf.data() + mid;
+    end = buf.data() + buf.size();
+
+    *p++ = '\t';
+    p = std::to_chars(p, end, t.price).ptr;   *p++ = '\t';
+    p = std::to_chars(p, end, t.volume).ptr;  *p++ = '\t';
+    *p++ = t.side;                            *p++ = '\t';
+    *p++ = t.type;                            *p++ = '\t';
+    *p++ = t.is_pro ? 't' : 'f';
+    *p++ = '\n';
+    buf.resize(static_cast<size_t>(p - buf.data()));
+}
+
+void CopyRowEncoder::append_text(std::string& buf, std::string_view text)
+{
+    for (char c : text)
+    {
+        switch (c)
+        {
+        case '\\': buf += "\\\\"; break;
+        case '\t': buf += "\\t";  break;
+        case '\n': buf += "\\n";  break;
+        case '\r': buf += "\\r";  break;
+        default:   buf += c;      break;
+        }
+    }
+}
+
+long long CopyRowEncoder::encoded_size(std::span<const Trade> rows)
+{
+    std::string buf;
+    long long total = 0;
+    for (const auto& t : rows)
+    {
+        buf.clear();
+        append(buf, t);
+        total += static_cast<long long>(buf.size());
+    }
+    return total;
+}
+
+// =============================================================================
+// CopyBinaryDecoder
+// =============================================================================
+// Network byte order → host. Written with shifts so it is correct on any
+// host; compilers turn each into a single bswap instruction.
+static uint16_t load_be16(const char* p)
+{
+    const auto* b = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<uint16_t>((b[0] << 8) | b[1]);
+}
+
+static uint32_t load_be32(const char* p)
+{
+    const auto* b = reinterpret_cast<const unsigned char*>(p);
+    return (uint32_t{b[0]} << 24) | (uint32_t{b[1]} << 16) | (uint32_t{b[2]} << 8) | b[3];
+}
+
+static uint64_t load_be64(const char* p)
+{
+    return (uint64_t{load_be32(p)} << 32) | load_be32(p + 4);
+}
+
+static void store_be(std::string& buf, uint64_t v, int bytes)
+{
+    for (int shift = 8 * (bytes - 1); shift >= 0; shift -= 8)
+        buf += static_cast<char>((v >> shift) & 0xFF);
+}
+
+static constexpr char BINARY_SIGNATURE[11] = {'P', 'G', 'C', 'O', 'P', 'Y', '\n', '\377', '\r', '\n', '\0'};
+
+void CopyBinaryEncoder::header(std::string& buf)
+{
+    buf.append(BINARY_SIGNATURE, sizeof(BINARY_SIGNATURE));
+    store_be(buf, 0, 4); // flags: no OIDs
+    store_be(buf, 0, 4); // header extension length
+}
+
+void CopyBinaryEncoder::append(std::string& buf, const Trade& t)
+{
+    uint64_t price_bits;
+    std::memcpy(&price_bits, &t.price, sizeof(price_bits));
+
+    store_be(buf, 9, 2);
+    store_be(buf, 8, 4); store_be(buf, t.trade_id, 8);
+    store_be(buf, 8, 4); store_be(buf, t.order_id, 8);
+    store_be(buf, 8, 4); store_be(buf, static_cast<uint64_t>(t.timestamp), 8);
+    store_be(buf, t.symbol.size(), 4); buf += t.symbol;
+    store_be(buf, 8, 4); store_be(buf, price_bits, 8);
+    store_be(buf, 4, 4); store_be(buf, t.volume, 4);
+    store_be(buf, 1, 4); buf += t.side;
+    store_be(buf, 1, 4); buf += t.type;
+    store_be(buf, 1, 4); buf += static_cast<char>(t.is_pro ? 1 : 0);
+}
+
+void CopyBinaryEncoder::trailer(std::string& buf)
+{
+    store_be(buf, 0xFFFF, 2); // field count -1
+}
+
+void CopyBinaryDecoder::feed(std::string_view data, std::vector<Trade>& out)
+{
+    if (pending_.empty())
+    {
+        // Common case: the block ends on a row boundary — decode in place
+        const size_t used = decode(data.data(), data.size(), out);
+        pending_.assign(data.substr(used));
+        return;
+    }
+    pending_.append(data);
+    const size_t used = decode(pending_.data(), pending_.size(), out);
+    pending_.erase(0, used);
+}
+
+size_t CopyBinaryDecoder::decode(const char* p, size_t n, std::vector<Trade>& out)
+{
+    constexpr int FIELDS = 9;
+    // Fixed widths of the 9 columns; 0 = variable (symbol)
+    static constexpr int32_t WIDTH[FIELDS] = {8, 8, 8, 0, 8, 4, 1, 1, 1};
+
+    size_t pos = 0;
+    if (!header_done_)
+    {
+        if (n < 19)
+            return 0;
+        if (std::memcmp(p, BINARY_SIGNATURE, sizeof(BINARY_SIGNATURE)) != 0)
+            throw std::runtime_error("[EXTRACT] Not a binary COPY stream");
+        const size_t ext = load_be32(p + 15);
+        if (n < 19 + ext)
+            return 0;
+        pos = 19 + ext;
+        header_done_ = true;
+    }
+
+    while (!finished_ && pos + 2 <= n)
+    {
+        const auto fields = static_cast<int16_t>(load_be16(p + pos));
+        if (fields == -1)
+        {
+            finished_ = true;
+            pos += 2;
+            break;
+        }
+        if (fields != FIELDS)
+            throw std::runtime_error("[EXTRACT] Expected 9 columns, got " + std::to_string(fields));
+
+        // Locate all fields first: a row is decoded only once it is complete
+        const char* field[FIELDS];
+        int32_t len[FIELDS];
+        size_t q = pos + 2;
+        for (int i = 0; i < FIELDS; ++i)
+        {
+            if (q + 4 > n)
+                return pos;
+            len[i] = static_cast<int32_t>(load_be32(p + q));
+            q += 4;
+            if (len[i] < 0)
+                throw std::runtime_error("[EXTRACT] Unexpected NULL in column " + std::to_string(i));
+            if (WIDTH[i] != 0 && len[i] != WIDTH[i])
+                throw std::runtime_error("[EXTRACT] Column " + std::to_string(i) + " has width " +
+                                         std::to_string(len[i]) + " (column type changed?)");
+            if (q + static_cast<size_t>(len[i]) > n)
+                return pos;
+            field[i] = p + q;
+            q += static_cast<size_t>(len[i]);
+        }
+
+        Trade& t = out.emplace_back();
+        t.trade_id = load_be64(field[0]);
+        t.order_id = load_be64(field[1]);
+        t.timestamp = static_cast<long long>(load_be64(field[2]));
+        t.symbol.assign(field[3], static_cast<size_t>(len[3]));
+        const uint64_t price_bits = load_be64(field[4]);
+        std::memcpy(&t.price, &price_bits, sizeof(t.price));
+        t.volume = load_be32(field[5]);
+        t.side = field[6][0];
+        t.type = field[7][0];
+        t.is_pro = field[8][0] != 0;
+        pos = q;
+    }
+    return pos;
+}
+
+// =============================================================================
+// PgCopyStream
+// =============================================================================
+PgCopyStream::PgCopyStream(const std::string& conn_str)
+    : conn_(PQconnectdb(conn_str.c_str()))
+{
+    if (PQstatus(conn_) != CONNECTION_OK)
+    {
+        std::string msg = std::string("[COPY] Connection failed: ") + PQerrorMessage(conn_);
+        PQfinish(conn_);
+        conn_ = nullptr;
+        throw std::runtime_error(msg);
+    }
+}
+
+PgCopyStream::~PgCopyStream()
+{
+    // PQfinish on a connection still in COPY mode simply drops it — the
+    // server aborts the open transaction. Same effect as pqxx on exception.
+    if (out_) PQfreemem(out_);
+    if (conn_) PQfinish(conn_);
+}
+
+void PgCopyStream::fail(const std::string& what) const
+{
+    throw std::runtime_error("[COPY] " + what + ": " + PQerrorMessage(conn_));
+}
+
+void PgCopyStream::exec(const std::string& sql)
+{
+    PGresult* res = PQexec(conn_, sql.c_str());
+    const bool ok = PQresultStatus(res) == PGRES_COMMAND_OK;
+    PQclear(res);
+    if (!ok) fail(sql.substr(0, 60));
+}
+
+void PgCopyStream::begin_copy(const std::string& copy_sql)
+{
+    PGresult* res = PQexec(conn_, copy_sql.c_str());
+    const bool ok = PQresultStatus(res) == PGRES_COPY_IN;
+    PQclear(res);
+    if (!ok) fail("COPY did not start");
+}
+
+void PgCopyStream::put(std::string_view data)
+{
+    // Blocking connection: returns 1 once libpq has queued or sent the data.
+    if (PQputCopyData(conn_, data.data(), static_cast<int>(data.size())) != 1)
+        fail("PQputCopyData failed");
+}
+
+long long PgCopyStream::end_copy()
+{
+    if (PQputCopyEnd(conn_, nullptr) != 1)
+        fail("PQputCopyEnd failed");
+
+    long long rows = 0;
+    bool ok = true;
+    // Drain every result — libpq requires PQgetResult until it returns null.
+    while (PGresult* res = PQgetResult(conn_))
+    {
+        if (PQresultStatus(res) == PGRES_COMMAND_OK)
+            rows = std::strtoll(PQcmdTuples(res), nullptr, 10);
+        else
+            ok = false;
+        PQclear(res);
+    }
+    if (!ok) fail("COPY failed");
+    return rows;
+}
+
+void PgCopyStream::begin_copy_out(const std::string& copy_sql)
+{
+    PGresult* res = PQexec(conn_, copy_sql.c_str());
+    const bool ok = PQresultStatus(res) == PGRES_COPY_OUT;
+    PQclear(res);
+    if (!ok) fail("COPY TO did not start");
+}
+
+std::string_view PgCopyStream::get()
+{
+    if (out_)
+    {
+        PQfreemem(out_);
+        out_ = nullptr;
+    }
+
+    // async = 0: block until a whole CopyData message is available
+    const int n = PQgetCopyData(conn_, &out_, 0);
+    if (n > 0)
+        return {out_, static_cast<size_t>(n)};
+    if (n == -2)
+        fail("PQgetCopyData failed");
+
+    // n == -1: COPY finished — collect its final status
+    bool ok = true;
+    while (PGresult* res = PQgetResult(conn_))
+    {
+        ok = ok && PQresultStatus(res) == PGRES_COMMAND_OK;
+        PQclear(res);
+    }
+    if (!ok) fail("COPY TO failed");
+    return {};
+}
+
+// =============================================================================
+// AsyncCopyWriter
+// =============================================================================
+// libpq non-blocking rules followed here:
+//   • PQputCopyData() may return 0 ("could not queue") — wait, then retry.
+//   • PQflush() returns 1 while data remains; wait for the socket to become
+//     writable (or readable — then PQconsumeInput() first) and call again.
+// =============================================================================
+static void copy_fail(PGconn* conn, const char* what)
+{
+    throw std::runtime_error(std::string("[COPY] ") + what + ": " + PQerrorMessage(conn));
+}
+
+AsyncCopyWriter::AsyncCopyWriter(PgCopyStream& stream, size_t block_bytes)
+    : stream_(stream), conn_(stream.native()), block_(block_bytes),
+      start_(std::chrono::steady_clock::now())
+{
+    if (PQsetnonblocking(conn_, 1) != 0)
+        copy_fail(conn_, "PQsetnonblocking failed");
+    back_.reserve(block_ + 512);
+}
+
+AsyncCopyWriter::~AsyncCopyWriter()
+{
+    PQsetnonblocking(conn_, 0);
+}
+
+void AsyncCopyWriter::write(const Trade& t)
+{
+    CopyRowEncoder::append(back_, t);
+    ++stats_.rows;
+
+    if (back_.size() >= block_)
+    {
+        submit();
+    }
+    else if (++since_pump_ == PUMP_ROWS)
+    {
+        since_pump_ = 0;
+        pump(0); // never blocks — just keeps the front moving
+    }
+}
+
+void AsyncCopyWriter::pump(int timeout_ms)
+{
+    if (!front_pending_)
+        return;
+
+    pollfd pfd{PQsocket(conn_), POLLOUT | POLLIN, 0};
+    const int ready = poll(&pfd, 1, timeout_ms);
+    if (ready < 0)
+    {
+        if (errno == EINTR) return;
+        copy_fail(conn_, "poll failed");
+    }
+    if (ready == 0)
+        return; // socket still full
+
+    // The server only talks during COPY IN to report an error; reading it
+    // keeps PQflush from stalling and surfaces the message.
+    if ((pfd.revents & POLLIN) && PQconsumeInput(conn_) == 0)
+        copy_fail(conn_, "PQconsumeInput failed");
+
+    const int rc = PQflush(conn_);
+    if (rc < 0)
+        copy_fail(conn_, "PQflush failed");
+    front_pending_ = rc == 1;
+}
+
+void AsyncCopyWriter::drain()
+{
+    if (!front_pending_)
+        return;
+    auto t0 = std::chrono::steady_clock::now();
+    while (front_pending_)
+        pump(-1);
+    stats_.wait_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - t0).count();
+}
+
+void AsyncCopyWriter::submit()
+{
+    if (back_.empty())
+        return;
+
+    drain(); // front must be empty before the next block goes in
+
+    for (;;)
+    {
+        const int rc = PQputCopyData(conn_, back_.data(), static_cast<int>(back_.size()));
+        if (rc == 1) break;
+        if (rc < 0) copy_fail(conn_, "PQputCopyData failed");
+        front_pending_ = true; // rc == 0: libpq buffer full — wait, retry
+        drain();
+    }
+    stats_.bytes += static_cast<long long>(back_.size());
+    back_.clear();
+    since_pump_ = 0;
+
+    const int rc = PQflush(conn_);
+    if (rc < 0)
+        copy_fail(conn_, "PQflush failed");
+    front_pending_ = rc == 1;
+}
+
+long long AsyncCopyWriter::finish()
+{
+    submit();
+    drain();
+
+    // Everything is on the wire: the end-of-data message and the result
+    // read are tiny, so finish in ordinary blocking mode.
+    if (PQsetnonblocking(conn_, 0) != 0)
+        copy_fail(conn_, "PQsetnonblocking failed");
+    const long long rows = stream_.end_copy();
+
+    stats_.total_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - start_).count();
+    return rows;
+}
+
+} // namespace MarketStream
@@ -0,0 +1,240 @@
+#pragma once
+
+// ============================================================================
+// CopyStream — Raw libpq COPY (in and out) + fast row encoder / decoder
+// ============================================================================
+//
+// WHY NOT pqxx::stream_to FOR EVERYTHING?
+// stream_to always sends the plain "COPY table (cols) FROM STDIN". There is
+// no way to add options such as WITH (FREEZE), and no way to control when
+// data is flushed to the socket. Both matter for bulk loading:
+//   • FREEZE writes rows already frozen — no hint-bit rewrite and no
+//     anti-wraparound VACUUM pass over freshly loaded pages later.
+//   • Controlling the send buffer lets us batch rows into ~64 KB messages.
+//
+// libpq (the C library under pqxx) exposes the COPY sub-protocol directly:
+//   PQexec("COPY ... FROM STDIN ...")  → PGRES_COPY_IN
+//   PQputCopyData(conn, buf, len)      → send a block of rows
+//   PQputCopyEnd(conn, nullptr)        → end of data
+//   PQgetResult(conn)                  → final status + row count
+//
+// PgCopyStream owns ONE connection (RAII, like pqxx::connection) and is
+// used the same way DatabaseLoader uses pqxx: one instance per thread.
+//
+// AsyncCopyWriter drives that connection in NON-BLOCKING mode so the thread
+// encodes the next block while the kernel is still sending the previous one.
+//
+// The reverse direction (extracts) uses the same connection class:
+//   PQexec("COPY (SELECT ...) TO STDOUT (FORMAT BINARY)") → PGRES_COPY_OUT
+//   PQgetCopyData(conn, &buf, 0)       → next block of rows, -1 at the end
+// and CopyBinaryDecoder turns the binary rows straight into Trades.
+// ============================================================================
+
+#include <string>
+#include <string_view>
+#include <span>
+#include <vector>
+#include <chrono>
+#include <libpq-fe.h>
+#include "../model/Trade.hpp"
+
+namespace MarketStream
+{
+
+    // ============================================================================
+    // CopyRowEncoder — Trade → one line of COPY text format
+    // ============================================================================
+    // Format: columns separated by TAB, row terminated by '\n', in the column
+    // order of COLUMNS below (the same order DatabaseLoader::copy_chunk uses).
+    // Numbers are written with std::to_chars: no locale, no iostream, and the
+    // shortest representation that round-trips a double exactly.
+    // ============================================================================
+    struct CopyRowEncoder
+    {
+        static constexpr const char *COLUMNS =
+            "(trade_id, order_id, timestamp, symbol, price, volume, side, type, is_pro)";
+
+        // Append one row to buf. Never shrinks buf — callers reuse it.
+        static void append(std::string &buf, const Trade &t);
+
+        // Escape \, TAB, LF, CR as COPY text format requires
+        static void append_text(std::string &buf, std::string_view text);
+
+        // Bytes `rows` occupy on the wire — same for every COPY engine
+        static long long encoded_size(std::span<const Trade> rows);
+    };
+
+    // ============================================================================
+    // CopyBinaryEncoder — Trade → one row of COPY ... (FORMAT BINARY)
+    // ============================================================================
+    // The inverse of CopyBinaryDecoder below (same layout, same column order).
+    // Stream = header() once, append() per row, trailer() once.
+    // A row is LARGER than its text form (~85 vs ~65 bytes for a realistic
+    // trade: fixed 8-byte integers + a 4-byte length per field), but the
+    // server skips number parsing — which of the two wins is measured by
+    // db_load_benchmark, not assumed.
+    // ============================================================================
+    struct CopyBinaryEncoder
+    {
+        static void header(std::string &buf);
+        static void append(std::string &buf, const Trade &t);
+        static void trailer(std::string &buf);
+    };
+
+    // ============================================================================
+    // CopyBinaryDecoder — COPY ... (FORMAT BINARY) rows → Trade
+    // ============================================================================
+    // WHY BINARY FOR EXTRACTS?
+    // Text COPY makes the server print every number and us parse it back —
+    // float8 through a shortest-round-trip printer and strtod on the way back.
+    // Binary COPY sends each column in its internal form (big-endian):
+    // decoding a BIGINT is one byte swap, a float8 is a byte swap + bit copy.
+    //
+    // STREAM LAYOUT:
+    //   header   "PGCOPY\n\377\r\n\0" | int32 flags | int32 ext_len | ext
+    //   row      int16 field count | per field: int32 length (-1 = NULL) | bytes
+    //   trailer  int16 -1
+    // Columns must arrive in COLUMNS order. The server's data blocks may split
+    // a row anywhere; an incomplete row is kept and finished by the next feed().
+    // ============================================================================
+    class CopyBinaryDecoder
+    {
+    public:
+        static constexpr const char *COLUMNS =
+            "trade_id, order_id, timestamp, symbol, price, volume, side, type, is_pro";
+
+        // Decode every complete row in `data` (plus leftovers) onto `out`
+        void feed(std::string_view data, std::vector<Trade> &out);
+
+        // The trailer has been seen — the stream is complete
+        [[nodiscard]] bool finished() const { return finished_; }
+
+    private:
+        // Returns bytes consumed; stops at the first incomplete row
+        size_t decode(const char *p, size_t n, std::vector<Trade> &out);
+
+        std::string pending_; // bytes of a row split across blocks
+        bool header_done_ = false;
+        bool finished_ = false;
+    };
+
+    // Per-stream throughput numbers (one COPY connection)
+    struct CopyStreamStats
+    {
+        long long rows = 0;
+        long long bytes = 0;     // COPY bytes sent (text) or received (binary extract)
+        long long total_ns = 0;  // whole stream, connect excluded
+        long long wait_ns = 0;   // blocked waiting for the socket / the server
+        // total_ns - wait_ns = encoding + libpq calls (the CPU side)
+
+        [[nodiscard]]
+        double mb_per_sec() const
+        {
+            return total_ns > 0 ? static_cast<double>(bytes) * 1e3 / static_cast<double>(total_ns) : 0.0;
+        }
+    };
+
+    // ============================================================================
+    // PgCopyStream — one libpq connection driving COPY FROM STDIN
+    // ============================================================================
+    class PgCopyStream
+    {
+    public:
+        explicit PgCopyStream(const std::string &conn_str);
+        ~PgCopyStream();
+
+        PgCopyStream(const PgCopyStream &) = delete;
+        PgCopyStream &operator=(const PgCopyStream &) = delete;
+
+        // Run a statement that returns no rows (BEGIN, TRUNCATE, DDL, COMMIT)
+        void exec(const std::string &sql);
+
+        // Start "COPY ... FROM STDIN ..." — the connection is now in COPY mode
+        void begin_copy(const std::string &copy_sql);
+
+        // Send a block of already-encoded rows (blocking)
+        void put(std::string_view data);
+
+        // Finish the COPY; returns the row count reported by the server
+        long long end_copy();
+
+        // Start "COPY ... TO STDOUT ..." — then read with get()
+        void begin_copy_out(const std::string &copy_sql);
+
+        // Next block of COPY OUT data (blocking). Empty once the COPY is
+        // complete — its final status is checked then. The view is valid
+        // until the next get().
+        std::string_view get();
+
+        [[nodiscard]]
+        PGconn *native() const { return conn_; }
+
+    private:
+        [[noreturn]] void fail(const std::string &what) const;
+
+        PGconn *conn_ = nullptr;
+        char *out_ = nullptr; // last PQgetCopyData block (PQfreemem)
+    };
+
+    // ============================================================================
+    // AsyncCopyWriter — double-buffered, non-blocking COPY sender
+    // ============================================================================
+    // WHY?
+    // With a blocking connection one thread alternates:
+    //   encode 64 KB ──► send (thread sleeps until the socket drains) ──► encode ...
+    // so the CPU idles while the socket is busy and vice versa.
+    //
+    // TWO BUFFERS:
+    //   back  — our std::string; rows are encoded into it
+    //   front — libpq's output buffer; PQputCopyData() copies a full back
+    //           block there and PQflush() pushes it to the socket piecewise
+    //
+    //   encode block N+1 into back ─┐   (every PUMP_ROWS rows: poll(0) —
+    //   flush block N from front  ──┘    socket writable? → PQflush once more)
+    //
+    // A new block is only handed over once the previous one is fully flushed,
+    // so at most two blocks are in flight: memory stays bounded at ~2 × block.
+    // Time spent waiting in poll() for a full front is counted in wait_ns —
+    // if it is large the network/server is the bottleneck, not encoding.
+    //
+    // USAGE (stream must already be in COPY mode):
+    //   AsyncCopyWriter w(stream);
+    //   for (const Trade& t : rows) w.write(t);
+    //   long long n = w.finish();     // drains, ends the COPY
+    // ============================================================================
+    class AsyncCopyWriter
+    {
+    public:
+        static constexpr size_t DEFAULT_BLOCK = 256 * 1024;
+        static constexpr size_t PUMP_ROWS = 256; // ~25 KB of encoding between socket checks
+
+        explicit AsyncCopyWriter(PgCopyStream &stream, size_t block_bytes = DEFAULT_BLOCK);
+        ~AsyncCopyWriter(); // back to blocking mode
+
+        AsyncCopyWriter(const AsyncCopyWriter &) = delete;
+        AsyncCopyWriter &operator=(const AsyncCopyWriter &) = delete;
+
+        void write(const Trade &t);
+
+        // Send what is left, end the COPY; returns the server's row count
+        long long finish();
+
+        [[nodiscard]]
+        const CopyStreamStats &stats() const { return stats_; }
+
+    private:
+        void submit();             // back → libpq (after front has drained)
+        void pump(int timeout_ms); // one poll + PQflush step
+        void drain();              // pump until front is empty
+
+        PgCopyStream &stream_;
+        PGconn *conn_;
+        size_t block_;
+        std::string back_;
+        size_t since_pump_ = 0;
+        bool front_pending_ = false; // libpq still holds unsent bytes
+        CopyStreamStats stats_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+} // namespace MarketStream
@@ -22,14 +22,34 @@
 //   4. save_indicators()          — saves computed RSI/SMA/VWAP rows
 //   5. prepare_for_parallel_load() — TRUNCATE + DROP PK (must run BEFORE threads)
 //   6. copy_chunk()               — per-thread COPY stream (runs IN parallel)
-//   7. finalize_parallel_load()   — REBUILD PK + index (runs AFTER all threads)
+//   7. finalize_parallel_load()   — REBUILD PK + index concurrently (AFTER all threads)
+//   8. save_order_flow()          — saves buy/sell, pro/retail aggregates
+//   9. save_order_fills()         — replaces / merges per-order fill aggregates (COPY)
+//  10. parse/resolve_load_mode()  — Replace vs Append vs AppendRebuild
+//  11. prepare_for_append_load()  — create + empty UNLOGGED staging table
+//  12. finalize_append_load()     — merge staging into trades (ON CONFLICT)
+//  13. partition_name() / prepare_partition_load() — per-day load tables
+//  14. build_partition_index()    — one index of one day (runs IN parallel)
+//  15. attach_partitions()        — DETACH old day (or merge it in), ATTACH new day
+//  16. freeze_load()              — TRUNCATE + COPY FREEZE, one transaction
+//  17. copy_partition_freeze()    — CREATE day table + COPY FREEZE
+//  18. copy_chunk_async()         — copy_chunk() on the non-blocking libpq writer
+//  19. export_snapshot() / extract_bounds() / extract_range() — binary COPY TO for backfills
 // =============================================================================
 
 #include "DatabaseLoader.hpp"
+#include "CopyStream.hpp"
 #include <iostream>
 #include <tuple>      // std::make_tuple — used to pass a row to pqxx::stream_to
 #include <chrono>     // std::chrono::system_clock — for timestamping indicators
 #include <span>       // std::span — C++20 zero-copy slice of a vector
+#include <string>     // std::to_string — builds the size_histogram array literal
+#include <stdexcept>  // std::invalid_argument — unknown ETL_LOAD_MODE
+#include <cstdio>     // std::snprintf — partition names
+#include <future>     // std::async — concurrent index builds in finalize
+#include <exception>  // std::exception_ptr — first failing index build
+#include <algorithm>  // std::all_of — extract symbol / snapshot check
+#include <cctype>     // std::isalnum, std::isxdigit
 
 namespace MarketStream
 {
@@ -124,6 +144,32 @@ void DatabaseLoader::init_schema()
             ON trades (symbol, timestamp);
         )");
 
+        // Create trades_daily — same columns, RANGE-partitioned by day on timestamp.
+        // The parent holds no rows; each day is its own table (trades_daily_YYYYMMDD),
+        // created and attached by PartitionedLoader.
+        // WHY (trade_id, timestamp) AS THE KEY?
+        // A unique index on a partitioned table must include the partition key,
+        // so uniqueness can be checked inside one partition.
+        W.exec(R"(
+            CREATE TABLE IF NOT EXISTS trades_daily (
+                trade_id  BIGINT           NOT NULL,
+                order_id  BIGINT           NOT NULL,
+                timestamp BIGINT           NOT NULL,
+                symbol    VARCHAR(10)      NOT NULL,
+                price     DOUBLE PRECISION NOT NULL CHECK (price > 0),
+                volume    INTEGER          NOT NULL CHECK (volume > 0),
+                side      CHAR(1)          NOT NULL CHECK (side IN ('B','S','N')),
+                type      CHAR(1)          NOT NULL CHECK (type IN ('M','L','I')),
+                is_pro    BOOLEAN          NOT NULL,
+                PRIMARY KEY (trade_id, timestamp)
+            ) PARTITION BY RANGE (timestamp);
+        )");
+
+        W.exec(R"(
+            CREATE INDEX IF NOT EXISTS idx_trades_daily_symbol_time
+            ON trades_daily (symbol, timestamp);
+        )");
+
         // Create technical_indicators table
         // BIGSERIAL = auto-incrementing 64-bit integer. PostgreSQL assigns it automatically.
         // computed_at BIGINT = nanoseconds since epoch — when we ran the pipeline.
@@ -147,8 +193,55 @@ void DatabaseLoader::init_schema()
             ON technical_indicators (symbol, computed_at);
         )");
 
+        // Create order_flow table — one row per (symbol, time bucket) per run.
+        // Same append-only pattern as technical_indicators (computed_at).
+        // size_histogram BIGINT[] = trade counts per log2 size band:
+        //   size_histogram[1] = 1-share trades, [7] = 64..127 shares, ...
+        //   (PostgreSQL arrays are 1-based)
+        // One array column instead of 16 band columns keeps the table narrow
+        // and lets SQL unnest() it when needed.
+        W.exec(R"(
+            CREATE TABLE IF NOT EXISTS order_flow (
+                id             BIGSERIAL        PRIMARY KEY,
+                symbol         VARCHAR(10)      NOT NULL,
+                bucket_start   BIGINT           NOT NULL,
+                bucket_ns      BIGINT           NOT NULL CHECK (bucket_ns >= 0),
+                computed_at    BIGINT           NOT NULL,
+                trade_count    BIGINT           NOT NULL CHECK (trade_count > 0),
+                buy_volume     BIGINT           NOT NULL,
+                sell_volume    BIGINT           NOT NULL,
+                unknown_volume BIGINT           NOT NULL,
+                pro_volume     BIGINT           NOT NULL,
+                retail_volume  BIGINT           NOT NULL,
+                imbalance      DOUBLE PRECISION NOT NULL CHECK (imbalance >= -1 AND imbalance <= 1),
+                pro_share      DOUBLE PRECISION NOT NULL CHECK (pro_share >= 0 AND pro_share <= 1),
+                size_histogram BIGINT[]         NOT NULL
+            );
+        )");
+
+        W.exec(R"(
+            CREATE INDEX IF NOT EXISTS idx_order_flow_symbol_bucket
+            ON order_flow (symbol, bucket_start);
+        )");
+
+        // Create order_fills table — one row per order_id, derived from trades.
+        // Replaced on a Replace run, merged per order_id on an append run
+        // (see save_order_fills()), so order_id alone is the primary key.
+        W.exec(R"(
+            CREATE TABLE IF NOT EXISTS order_fills (
+                order_id      BIGINT           PRIMARY KEY,
+                symbol        VARCHAR(10)      NOT NULL,
+                side          CHAR(1)          NOT NULL CHECK (side IN ('B','S','N')),
+                fill_count    INTEGER          NOT NULL CHECK (fill_count > 0),
+                filled_qty    BIGINT           NOT NULL CHECK (filled_qty > 0),
+                vwap          DOUBLE PRECISION NOT NULL CHECK (vwap > 0),
+                first_fill_ns BIGINT           NOT NULL,
+                last_fill_ns  BIGINT           NOT NULL
+            );
+        )");
+
         W.commit();  // Makes all the above permanent in the database
-        std::cout << "[DB] Schema initialized (tables: trades, technical_indicators).\n";
+        std::cout << "[DB] Schema initialized (tables: trades, trades_daily, technical_indicators, order_flow, order_fills).\n";
     }
     catch (const std::exception& e)
     {
@@ -393,6 +486,10 @@ void DatabaseLoader::prepare_for_parallel_load()
         // DROP the composite index as well.
         W.exec("DROP INDEX IF EXISTS idx_trades_symbol_time");
 
+        // A unique index left behind by a finalize that failed before the
+        // PRIMARY KEY was attached (see finalize_parallel_load()).
+        W.exec("DROP INDEX IF EXISTS trades_pkey_build");
+
         W.commit();
         std::cout << "[PARALLEL-LOAD] Table truncated. Constraints dropped. Ready for parallel COPY.\n";
     }
@@ -436,9 +533,18 @@ void DatabaseLoader::prepare_for_parallel_load()
 //   Multiple threads reading the same memory simultaneously = always safe.
 //   Only writes cause races. We never write to shared memory here.
 // =============================================================================
-void DatabaseLoader::copy_chunk(std::span<const Trade> chunk, int thread_id)
+void DatabaseLoader::copy_chunk(std::span<const Trade> chunk, int thread_id,
+                                const std::string& table)
+{
+    copy_chunk(std::vector<std::span<const Trade>>{chunk}, thread_id, table);
+}
+
+void DatabaseLoader::copy_chunk(const std::vector<std::span<const Trade>>& pieces,
+                                int thread_id, const std::string& table)
 {
-    if (chunk.empty()) return;
+    size_t rows = 0;
+    for (const auto& piece : pieces) rows += piece.size();
+    if (rows == 0) return;
 
     try
     {
@@ -453,27 +559,29 @@ void DatabaseLoader::copy_chunk(std::span<const Trade> chunk, int thread_id)
         // From this point, data flows: our loop → socket → PostgreSQL → disk.
         auto stream = pqxx::stream_to::table(
             W,
-            {"trades"},
+            {table},
             {"trade_id", "order_id", "timestamp", "symbol",
              "price", "volume", "side", "type", "is_pro"}
         );
 
-        // Iterate over our slice of trades.
-        // chunk[0] through chunk[chunk.size()-1].
-        // The data physically lives in main's vector — span is just a window.
-        for (const auto& t : chunk)
+        // Iterate over our slice(s) of trades.
+        // The data physically lives in main's vector — each span is just a window.
+        for (const auto& chunk : pieces)
         {
-            stream << std::make_tuple(
-                t.trade_id,
-                t.order_id,
-                t.timestamp,
-                t.symbol,
-                t.price,
-                static_cast<int>(t.volume),
-                std::string(1, t.side),
-                std::string(1, t.type),
-                t.is_pro
-            );
+            for (const auto& t : chunk)
+            {
+                stream << std::make_tuple(
+                    t.trade_id,
+                    t.order_id,
+                    t.timestamp,
+                    t.symbol,
+                    t.price,
+                    static_cast<int>(t.volume),
+                    std::string(1, t.side),
+                    std::string(1, t.type),
+                    t.is_pro
+                );
+            }
         }
 
         // complete() flushes the COPY buffer and signals end-of-data to PostgreSQL.
@@ -507,8 +615,8 @@ void DatabaseLoader::copy_chunk(std::span<const Trade> chunk, int thread_id)
 // PARAMETER: size_t total_rows
 //   Only used for logging. Tells us how many rows to expect.
 //
-// HOW PostgreSQL REBUILDS THE PRIMARY KEY INTERNALLY:
-//   1. Sequential scan of all N trade_id values (one pass, cache-friendly)
+// HOW PostgreSQL BUILDS A B-TREE INDEX INTERNALLY:
+//   1. Sequential scan of all N key values (one pass, cache-friendly)
 //   2. External merge sort of the values (O(N log N), sorted in temp files)
 //   3. Uniqueness check (trivial — adjacent duplicates visible after sort)
 //   4. Bottom-up B-tree construction from sorted data:
@@ -531,41 +639,1016 @@ void DatabaseLoader::copy_chunk(std::span<const Trade> chunk, int thread_id)
 // THIS IS EXACTLY HOW pg_restore -j N WORKS.
 // Same principle used by pgloader, pg_bulkload, and every serious ETL tool.
 //
-// WHY MUST THIS BE SEQUENTIAL?
-//   Same reason as prepare: ACCESS EXCLUSIVE lock on ALTER TABLE.
-//   Only one connection can rebuild the primary key at a time.
-//   We call this on the main thread after all workers have joined.
+// WHY TWO CONNECTIONS?
+//   One connection = one PostgreSQL backend = the two builds run back to back,
+//   and the serial rebuild often takes longer than the parallel COPY did.
+//   CREATE INDEX takes a SHARE lock, and SHARE does not conflict with SHARE:
+//   two builds on the same table from two backends run at the same time.
+//   ALTER TABLE ADD PRIMARY KEY would take ACCESS EXCLUSIVE and block the
+//   other build — so the key is built as a plain UNIQUE INDEX first.
+//
+// PRIMARY KEY USING INDEX:
+//   Promotes the finished unique index to the table's primary key (and
+//   renames it trades_pkey). trade_id is still NOT NULL from the original
+//   definition, so this is a catalog update — no scan, no second sort.
+//
+// SESSION TUNING (per build connection, see tune_index_session()):
+//   maintenance_work_mem — sort memory per build. The default 64MB spills a
+//                          1M-row sort to temp files; 512MB sorts in RAM.
+//   max_parallel_maintenance_workers — extra worker processes that scan and
+//                          sort in parallel for ONE build (PostgreSQL 11+).
 // =============================================================================
-void DatabaseLoader::finalize_parallel_load(size_t total_rows)
+static void tune_index_session(pqxx::work& W)
+{
+    W.exec(std::string("SET maintenance_work_mem = '") +
+           DatabaseLoader::INDEX_BUILD_WORK_MEM + "'");
+    W.exec("SET max_parallel_maintenance_workers = " +
+           std::to_string(DatabaseLoader::INDEX_BUILD_PARALLEL_WORKERS));
+}
+
+IndexBuildTimings DatabaseLoader::finalize_parallel_load(size_t total_rows)
 {
+    using Clock = std::chrono::high_resolution_clock;
+    IndexBuildTimings timings;
+
+    try
+    {
+        auto wall_start = Clock::now();
+        std::cout << "[DB] Building PRIMARY KEY and (symbol, timestamp) indexes over "
+                  << total_rows << " rows on 2 connections...\n";
+
+        // Each build: own connection, own transaction, own timing.
+        auto build = [this](const std::string& sql) -> long long
+        {
+            auto t0 = Clock::now();
+            pqxx::connection C(conn_str);
+            pqxx::work W(C);
+            tune_index_session(W);
+            W.exec(sql);
+            W.commit();
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count();
+        };
+
+        auto pk_future = std::async(std::launch::async, build,
+            std::string("CREATE UNIQUE INDEX trades_pkey_build ON trades (trade_id)"));
+        auto symbol_future = std::async(std::launch::async, build,
+            std::string("CREATE INDEX IF NOT EXISTS idx_trades_symbol_time ON trades (symbol, timestamp)"));
+
+        // get() both before rethrowing, so neither thread outlives this call
+        std::exception_ptr failure;
+        try { timings.primary_key_ns = pk_future.get(); }
+        catch (...) { failure = std::current_exception(); }
+        try { timings.symbol_time_ns = symbol_future.get(); }
+        catch (...) { if (!failure) failure = std::current_exception(); }
+        if (failure) std::rethrow_exception(failure);
+
+        // Promote the unique index to the primary key (brief ACCESS EXCLUSIVE)
+        auto attach_start = Clock::now();
+        {
+            pqxx::connection C(conn_str);
+            pqxx::work W(C);
+            W.exec("ALTER TABLE trades ADD CONSTRAINT trades_pkey "
+                   "PRIMARY KEY USING INDEX trades_pkey_build");
+            W.commit();
+        }
+        auto wall_end = Clock::now();
+        timings.attach_pk_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(wall_end - attach_start).count();
+        timings.wall_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(wall_end - wall_start).count();
+
+        std::cout << "[DB] Constraints rebuilt. Load finalized.\n";
+        std::cout << "[DB]   Total rows        : " << total_rows << "\n";
+        std::cout << "[DB]   PK index          : " << timings.primary_key_ns / 1'000'000 << "ms\n";
+        std::cout << "[DB]   Symbol/time index : " << timings.symbol_time_ns / 1'000'000 << "ms\n";
+        std::cout << "[DB]   PK attach         : " << timings.attach_pk_ns / 1'000'000 << "ms\n";
+        std::cout << "[DB]   Wall (overlapped) : " << timings.wall_ns / 1'000'000 << "ms\n";
+        return timings;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[DB ERROR] finalize_parallel_load failed: " << e.what() << "\n";
+        throw;
+    }
+}
+
+// =============================================================================
+// METHOD 8: save_order_flow()
+// =============================================================================
+// PURPOSE: Saves order-flow aggregates (one row per symbol per time bucket)
+//          into the order_flow table.
+//
+// WHY INSERT AND NOT COPY?
+//   Same reasoning as save_indicators(): a 1M-trade session with 10 symbols
+//   and 1-minute buckets is ~4K rows — one transaction of parameterized
+//   INSERTs is fast enough and keeps the SQL injection-safe.
+//
+// THE ARRAY PARAMETER:
+//   size_histogram is sent as PostgreSQL's text array literal "{3,17,0,...}"
+//   and cast with $13::BIGINT[]. The literal contains only digits and commas
+//   that WE generate — no user data is spliced into SQL.
+// =============================================================================
+void DatabaseLoader::save_order_flow(const std::vector<OrderFlowBucket>& buckets)
+{
+    if (buckets.empty())
+    {
+        std::cout << "[DB] No order-flow rows to save.\n";
+        return;
+    }
+
     try
     {
         pqxx::connection C(conn_str);
         pqxx::work W(C);
 
-        // This is the slow step. It does the sort + uniqueness check + B-tree build.
-        // Expected time for 1M rows: 1-3 seconds. Normal and expected.
-        std::cout << "[DB] Building PRIMARY KEY index over " << total_rows << " rows...\n";
-        W.exec("ALTER TABLE trades ADD PRIMARY KEY (trade_id)");
+        auto now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()
+        ).count();
 
-        // Rebuild the composite index for query performance.
-        // "Give me all RELIANCE trades after 10:30am" — this index makes it instant.
-        std::cout << "[DB] Building composite index (symbol, timestamp)...\n";
-        W.exec(R"(
-            CREATE INDEX IF NOT EXISTS idx_trades_symbol_time
-            ON trades (symbol, timestamp)
-        )");
+        for (const auto& b : buckets)
+        {
+            std::string histogram = "{";
+            for (size_t k = 0; k < b.size_histogram.size(); ++k)
+            {
+                if (k) histogram += ',';
+                histogram += std::to_string(b.size_histogram[k]);
+            }
+            histogram += '}';
+
+            // pqxx has no uint64_t conversion for BIGINT — cast to signed.
+            // Volumes are far below 2^63.
+            W.exec(
+                "INSERT INTO order_flow "
+                "(symbol, bucket_start, bucket_ns, computed_at, trade_count, "
+                " buy_volume, sell_volume, unknown_volume, pro_volume, retail_volume, "
+                " imbalance, pro_share, size_histogram) "
+                "VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, $12, $13::BIGINT[])",
+                pqxx::params{b.symbol, b.bucket_start, b.bucket_ns, now_ns,
+                             static_cast<long long>(b.trade_count),
+                             static_cast<long long>(b.buy_volume),
+                             static_cast<long long>(b.sell_volume),
+                             static_cast<long long>(b.unknown_volume),
+                             static_cast<long long>(b.pro_volume),
+                             static_cast<long long>(b.retail_volume),
+                             b.imbalance(), b.pro_share(), histogram}
+            );
+        }
 
         W.commit();
+        std::cout << "[DB] Saved " << buckets.size()
+                  << " order-flow rows to order_flow.\n";
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[DB ERROR] save_order_flow failed: " << e.what() << "\n";
+        throw;
+    }
+}
 
-        std::cout << "[DB] Constraints rebuilt. Load finalized.\n";
-        std::cout << "[DB]   Total rows : " << total_rows << "\n";
+// =============================================================================
+// METHOD 9: save_order_fills()
+// =============================================================================
+// PURPOSE: Writes this run's per-order aggregates (computed in memory by
+//          OrderAggregator) to order_fills.
+//
+// WHY COPY HERE (unlike save_indicators / save_order_flow)?
+//   One row per ORDER. With the generator's data that is one row per trade —
+//   1M rows. Parameterized INSERTs would be ~1M round-trips.
+//
+// merge = false (Replace / Freeze) — SAME DROP → COPY → REBUILD AS bulk_load():
+//   TRUNCATE, drop the primary key, stream all rows, rebuild the key once.
+//
+// merge = true (Append / AppendRebuild / Auto) — the batch is a DELTA:
+//   COPY into a temp table, then INSERT ... ON CONFLICT (order_id) DO UPDATE.
+//   An order that already has fills gets this batch's fills ADDED: counts
+//   and quantities sum, notional (vwap × qty) sums and vwap is recomputed,
+//   first/last fill widen with LEAST / GREATEST. Earlier orders are kept.
+//   A delta loaded twice counts its fills twice — unlike trades, a fill
+//   aggregate has no per-trade key left to deduplicate on.
+//
+// Either way ONE transaction: readers see the old fills or the new ones,
+// never a half-loaded table.
+// =============================================================================
+void DatabaseLoader::save_order_fills(const std::vector<OrderFill>& fills, bool merge)
+{
+    if (fills.empty())
+    {
+        std::cout << "[DB] No order fills to save.\n";
+        return;
+    }
+
+    try
+    {
+        pqxx::connection C(conn_str);
+        pqxx::work W(C);
+
+        const std::string target = merge ? "order_fills_delta" : "order_fills";
+        if (merge)
+        {
+            W.exec("CREATE TEMP TABLE order_fills_delta "
+                   "(LIKE order_fills INCLUDING DEFAULTS) ON COMMIT DROP");
+        }
+        else
+        {
+            W.exec("TRUNCATE TABLE order_fills");
+            W.exec("ALTER TABLE order_fills DROP CONSTRAINT IF EXISTS order_fills_pkey");
+        }
+
+        auto stream = pqxx::stream_to::table(
+            W,
+            {target},
+            {"order_id", "symbol", "side", "fill_count", "filled_qty",
+             "vwap", "first_fill_ns", "last_fill_ns"}
+        );
+
+        for (const auto& f : fills)
+        {
+            stream << std::make_tuple(
+                f.order_id,
+                f.symbol,
+                std::string(1, f.side),
+                static_cast<int>(f.fill_count),
+                static_cast<long long>(f.filled_qty),
+                f.vwap(),
+                f.first_fill_ns,
+                f.last_fill_ns
+            );
+        }
+
+        stream.complete();
+
+        size_t merged = 0;
+        if (merge)
+        {
+            pqxx::result R = W.exec(R"(
+                INSERT INTO order_fills AS o
+                SELECT * FROM order_fills_delta
+                ON CONFLICT (order_id) DO UPDATE SET
+                    fill_count    = o.fill_count + EXCLUDED.fill_count,
+                    filled_qty    = o.filled_qty + EXCLUDED.filled_qty,
+                    vwap          = (o.vwap * o.filled_qty + EXCLUDED.vwap * EXCLUDED.filled_qty)
+                                    / (o.filled_qty + EXCLUDED.filled_qty),
+                    first_fill_ns = LEAST(o.first_fill_ns, EXCLUDED.first_fill_ns),
+                    last_fill_ns  = GREATEST(o.last_fill_ns, EXCLUDED.last_fill_ns)
+            )");
+            merged = static_cast<size_t>(R.affected_rows());
+        }
+        else
+        {
+            W.exec("ALTER TABLE order_fills ADD PRIMARY KEY (order_id)");
+        }
+        W.commit();
+        if (merge)
+            std::cout << "[DB] Merged " << merged << " order fill rows into order_fills.\n";
+        else
+            std::cout << "[DB] Saved " << fills.size()
+                      << " order fill rows to order_fills.\n";
     }
     catch (const std::exception& e)
     {
-        std::cerr << "[DB ERROR] finalize_parallel_load failed: " << e.what() << "\n";
+        std::cerr << "[DB ERROR] save_order_fills failed: " << e.what() << "\n";
+        throw;
+    }
+}
+
+// =============================================================================
+// METHOD 10: parse_load_mode() / load_mode_name() / resolve_load_mode()
+// =============================================================================
+// WHY NOT ALWAYS REPLACE?
+//   Replace = TRUNCATE + full index rebuild. For the nightly 1M-row file that
+//   is the fastest path. For a 20K-row intraday correction on top of 50M
+//   existing rows it means re-sorting 50M keys to add 20K — and losing every
+//   row that is not in the new file.
+//
+// THE AUTO DECISION:
+//   table empty (probed, see below)   → Replace (nothing to keep, fastest load)
+//   delta / existing < 0.2            → Append  (O(delta · log N) index inserts)
+//   delta / existing ≥ 0.2            → AppendRebuild (one sort of N + delta
+//                                        beats that many random B-tree inserts)
+//
+// WHY pg_class.reltuples AND NOT COUNT(*)?
+//   COUNT(*) scans the whole table — the very cost we are trying to avoid.
+//   reltuples is the planner's estimate, kept fresh by VACUUM/ANALYZE and by
+//   index builds. A threshold decision does not need an exact count.
+//   Replace TRUNCATEs, so "empty" is never taken from the estimate: when
+//   reltuples ≤ 0 (-1 = never analyzed on PostgreSQL 14+, 0 = stale) a
+//   single-row EXISTS probe decides. Populated but unestimated → unknown
+//   size → AppendRebuild, the mode that is safe at any ratio.
+// =============================================================================
+LoadMode DatabaseLoader::parse_load_mode(std::string_view name)
+{
+    if (name == "replace")        return LoadMode::Replace;
+    if (name == "append")         return LoadMode::Append;
+    if (name == "append-rebuild") return LoadMode::AppendRebuild;
+    if (name == "auto")           return LoadMode::Auto;
+    if (name == "freeze")         return LoadMode::Freeze;
+    throw std::invalid_argument("Unknown load mode '" + std::string(name) +
+                                "' (expected replace | append | append-rebuild | auto | freeze)");
+}
+
+const char* DatabaseLoader::load_mode_name(LoadMode mode)
+{
+    switch (mode)
+    {
+    case LoadMode::Replace:       return "replace";
+    case LoadMode::Append:        return "append";
+    case LoadMode::AppendRebuild: return "append-rebuild";
+    case LoadMode::Auto:          return "auto";
+    case LoadMode::Freeze:        return "freeze";
+    }
+    return "unknown";
+}
+
+LoadMode DatabaseLoader::resolve_load_mode(LoadMode requested, size_t delta_rows)
+{
+    if (requested != LoadMode::Auto)
+        return requested;
+
+    try
+    {
+        pqxx::connection C(conn_str);
+        pqxx::work W(C);
+
+        const auto existing = W.query_value<long long>(
+            "SELECT reltuples::BIGINT FROM pg_class "
+            "WHERE oid = 'trades'::regclass");
+
+        // The estimate can say 0/-1 for a populated table — probe before
+        // choosing the mode that TRUNCATEs. Stops at the first row found.
+        const bool has_rows = existing > 0 ||
+                              W.query_value<bool>("SELECT EXISTS (SELECT 1 FROM trades)");
+        W.commit();
+
+        LoadMode mode;
+        if (!has_rows)
+            mode = LoadMode::Replace;
+        else if (existing <= 0)
+            mode = LoadMode::AppendRebuild; // rows present, count unknown
+        else if (static_cast<double>(delta_rows) / static_cast<double>(existing) < APPEND_REBUILD_RATIO)
+            mode = LoadMode::Append;
+        else
+            mode = LoadMode::AppendRebuild;
+
+        std::cout << "[DB] Load mode auto → " << load_mode_name(mode)
+                  << " (delta " << delta_rows << " rows, table ~" << existing << " rows)\n";
+        return mode;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[DB ERROR] resolve_load_mode failed: " << e.what() << "\n";
+        throw;
+    }
+}
+
+// =============================================================================
+// METHOD 11: prepare_for_append_load()
+// =============================================================================
+// PURPOSE: STEP 1 of an append load. The parallel COPY streams then write
+//          into trades_staging instead of trades (copy_chunk's table param).
+//
+// WHY A STAGING TABLE?
+//   COPY has no ON CONFLICT clause. A re-sent trade_id in the delta would
+//   abort the whole COPY against trades' primary key. Staging has no
+//   constraints, so the COPY always succeeds and duplicates are resolved
+//   afterwards in ONE set-based INSERT ... SELECT.
+//
+// WHY UNLOGGED?
+//   Staging rows are transient — if the server crashes we simply reload the
+//   delta. UNLOGGED skips the write-ahead log, roughly halving the write I/O
+//   of the COPY. The rows become durable when they are inserted into trades.
+//
+// LIKE trades (without INCLUDING INDEXES / CONSTRAINTS):
+//   Same columns and types, no primary key, no indexes — pure heap appends.
+// =============================================================================
+void DatabaseLoader::prepare_for_append_load()
+{
+    try
+    {
+        pqxx::connection C(conn_str);
+        pqxx::work W(C);
+
+        W.exec(std::string("CREATE UNLOGGED TABLE IF NOT EXISTS ") + STAGING_TABLE +
+               " (LIKE trades INCLUDING DEFAULTS)");
+        W.exec(std::string("TRUNCATE TABLE ") + STAGING_TABLE);
+
+        W.commit();
+        std::cout << "[APPEND-LOAD] Staging table " << STAGING_TABLE
+                  << " ready. trades keeps its rows and indexes.\n";
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[DB ERROR] prepare_for_append_load failed: " << e.what() << "\n";
+        throw;
+    }
+}
+
+// =============================================================================
+// METHOD 12: finalize_append_load()
+// =============================================================================
+// PURPOSE: STEP 3 of an append load. Moves staged rows into trades.
+//
+// rebuild_indexes = false (Append):
+//   INSERT ... ON CONFLICT (trade_id) DO NOTHING with both indexes in place.
+//   Each new row costs two B-tree inserts — cheap when the delta is small.
+//   Rows whose trade_id already exists (re-sent trades) are skipped, as are
+//   duplicates within the delta itself.
+//
+// rebuild_indexes = true (AppendRebuild):
+//   Drop both indexes, insert with an anti-join instead of ON CONFLICT
+//   (ON CONFLICT needs the unique index we just dropped), then rebuild once.
+//   DISTINCT ON (trade_id) removes duplicates inside the delta.
+//
+// Both run in ONE transaction together with emptying the staging table:
+// queries see the old trades or old + delta, never a partial merge.
+// =============================================================================
+size_t DatabaseLoader::finalize_append_load(bool rebuild_indexes)
+{
+    try
+    {
+        pqxx::connection C(conn_str);
+        pqxx::work W(C);
+
+        const std::string staging = STAGING_TABLE;
+        pqxx::result R;
+
+        if (!rebuild_indexes)
+        {
+            R = W.exec(
+                "INSERT INTO trades SELECT * FROM " + staging +
+                " ON CONFLICT (trade_id) DO NOTHING");
+        }
+        else
+        {
+            W.exec("ALTER TABLE trades DROP CONSTRAINT IF EXISTS trades_pkey");
+            W.exec("DROP INDEX IF EXISTS idx_trades_symbol_time");
+
+            R = W.exec(
+                "INSERT INTO trades "
+                "SELECT DISTINCT ON (s.trade_id) s.* FROM " + staging + " s "
+                "WHERE NOT EXISTS (SELECT 1 FROM trades t WHERE t.trade_id = s.trade_id) "
+                "ORDER BY s.trade_id");
+
+            std::cout << "[DB] Rebuilding PRIMARY KEY + (symbol, timestamp) index...\n";
+            W.exec("ALTER TABLE trades ADD PRIMARY KEY (trade_id)");
+            W.exec("CREATE INDEX IF NOT EXISTS idx_trades_symbol_time ON trades (symbol, timestamp)");
+        }
+
+        const auto inserted = static_cast<size_t>(R.affected_rows());
+        W.exec("TRUNCATE TABLE " + staging);
+        W.commit();
+
+        std::cout << "[DB] Append merge complete"
+                  << (rebuild_indexes ? " (indexes rebuilt)" : " (indexes kept)") << ".\n";
+        std::cout << "[DB]   Inserted : " << inserted << " new trades\n";
+        return inserted;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[DB ERROR] finalize_append_load failed: " << e.what() << "\n";
+        throw;
+    }
+}
+
+// =============================================================================
+// METHOD 13: partition_name() / partition_load_table() / prepare_partition_load()
+// =============================================================================
+// WHY LOAD INTO A DETACHED TABLE AND ATTACH AFTERWARDS?
+//   Loading straight into an attached partition would maintain the parent's
+//   indexes row by row, and a re-load of the same day would have to DELETE
+//   the old rows first. Instead each day is built on the side:
+//     trades_daily_20231025_load  ← COPY, then build its own two indexes
+//   and attach_partitions() swaps it in. The cost is proportional to the
+//   DAY's volume — months of history are never touched.
+//
+// THE CHECK CONSTRAINT:
+//   ATTACH PARTITION must prove every row fits the partition's range. Without
+//   help it scans the whole table under lock. A valid CHECK constraint that
+//   implies the range lets PostgreSQL skip that scan entirely.
+// =============================================================================
+std::string DatabaseLoader::partition_name(long long day)
+{
+    // days since epoch → civil date (proleptic Gregorian, UTC)
+    const std::chrono::year_month_day ymd{std::chrono::sys_days{std::chrono::days{day}}};
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "trades_daily_%04d%02u%02u",
+                  static_cast<int>(ymd.year()),
+                  static_cast<unsigned>(ymd.month()),
+                  static_cast<unsigned>(ymd.day()));
+    return buf;
+}
+
+std::string DatabaseLoader::partition_load_table(long long day)
+{
+    return partition_name(day) + "_load";
+}
+
+// The statements that (re)create one day's empty load table.
+// Shared by prepare_partition_load() and copy_partition_freeze().
+static std::vector<std::string> partition_load_ddl(long long day)
+{
+    const std::string load = DatabaseLoader::partition_load_table(day);
+    const long long lo = day * DatabaseLoader::NS_PER_DAY;
+    const long long hi = lo + DatabaseLoader::NS_PER_DAY;
+    return {
+        // A leftover from a failed run is discarded, never attached.
+        "DROP TABLE IF EXISTS " + load,
+        // INCLUDING CONSTRAINTS copies the CHECKs (price > 0, ...) that
+        // ATTACH requires; no indexes yet — COPY runs as pure appends.
+        "CREATE TABLE " + load + " (LIKE trades_daily INCLUDING DEFAULTS INCLUDING CONSTRAINTS)",
+        "ALTER TABLE " + load + " ADD CONSTRAINT " + load + "_range CHECK "
+        "(timestamp >= " + std::to_string(lo) + " AND timestamp < " + std::to_string(hi) + ")",
+    };
+}
+
+void DatabaseLoader::prepare_partition_load(const std::vector<long long>& days)
+{
+    try
+    {
+        pqxx::connection C(conn_str);
+        pqxx::work W(C);
+
+        for (long long day : days)
+        {
+            for (const auto& sql : partition_load_ddl(day))
+                W.exec(sql);
+        }
+
+        W.commit();
+        std::cout << "[PARTITION] Prepared " << days.size() << " daily load table(s).\n";
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[DB ERROR] prepare_partition_load failed: " << e.what() << "\n";
+        throw;
+    }
+}
+
+// =============================================================================
+// METHOD 14: build_partition_index()
+// =============================================================================
+// PURPOSE: Build ONE index on ONE day's load table. PartitionedLoader runs
+//          these as separate pool tasks — each on its own connection — so the
+//          two indexes of a day, and the indexes of different days, are built
+//          by separate PostgreSQL backends at the same time.
+//
+// The index definitions MUST match the parent's partitioned indexes. Then
+// ATTACH PARTITION adopts them as the partition's index instead of building
+// a new one under lock.
+// =============================================================================
+void DatabaseLoader::build_partition_index(long long day, bool primary)
+{
+    try
+    {
+        pqxx::connection C(conn_str);
+        pqxx::work W(C);
+
+        const std::string load = partition_load_table(day);
+        tune_index_session(W);
+        if (primary)
+            W.exec("CREATE UNIQUE INDEX " + load + "_pkey_idx ON " + load + " (trade_id, timestamp)");
+        else
+            W.exec("CREATE INDEX " + load + "_symbol_time_idx ON " + load + " (symbol, timestamp)");
+
+        W.commit();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[DB ERROR] build_partition_index (" << partition_name(day)
+                  << (primary ? ", pkey" : ", symbol/time") << ") failed: " << e.what() << "\n";
+        throw;
+    }
+}
+
+// =============================================================================
+// METHOD 15: attach_partitions()
+// =============================================================================
+// For each day, in ONE transaction:
+//   1. keep_existing: copy the day's current partition rows into the load
+//      table, skipping (trade_id, timestamp) keys the batch already has
+//   2. DETACH + DROP the day's current partition, if it exists
+//   3. RENAME the load table to the partition name
+//   4. ATTACH it FOR VALUES FROM (day start) TO (next day start)
+// Queries see either the old day or the new day — never both, never neither.
+//
+// WHY keep_existing?
+//   Without it a batch REPLACES every day it touches: one straggler trade
+//   from a day loaded last week would shrink that day to the straggler.
+//   Append modes (and Auto) therefore merge: the cost is one INSERT ... SELECT
+//   of the day's rows through the load table's unique index — still
+//   proportional to the day, never to the history.
+// The pre-built unique index is adopted as the partition's share of the
+// parent's PRIMARY KEY; the CHECK constraint skips the validation scan.
+// =============================================================================
+void DatabaseLoader::attach_partitions(const std::vector<long long>& days, bool keep_existing)
+{
+    try
+    {
+        pqxx::connection C(conn_str);
+        pqxx::work W(C);
+
+        for (long long day : days)
+        {
+            const std::string name = partition_name(day);
+            const long long lo = day * NS_PER_DAY;
+            const long long hi = lo + NS_PER_DAY;
+
+            const bool exists = W.query_value<bool>(
+                "SELECT EXISTS (SELECT 1 FROM pg_inherits i "
+                "JOIN pg_class c ON c.oid = i.inhrelid "
+                "WHERE i.inhparent = 'trades_daily'::regclass AND c.relname = '" + name + "')");
+            size_t kept = 0;
+            if (exists && keep_existing)
+            {
+                // The unique (trade_id, timestamp) index built in METHOD 14
+                // is the arbiter: rows re-sent in this batch are not doubled.
+                const std::string cols = CopyRowEncoder::COLUMNS;
+                kept = static_cast<size_t>(W.exec("INSERT INTO " + partition_load_table(day) + " " + cols +
+                              " SELECT " + cols.substr(1, cols.size() - 2) + " FROM " + name +
+                              " ON CONFLICT (trade_id, timestamp) DO NOTHING")
+                                               .affected_rows());
+            }
+            if (exists)
+            {
+                W.exec("ALTER TABLE trades_daily DETACH PARTITION " + name);
+                W.exec("DROP TABLE " + name);
+            }
+
+            W.exec("ALTER TABLE " + partition_load_table(day) + " RENAME TO " + name);
+            W.exec("ALTER TABLE trades_daily ATTACH PARTITION " + name +
+                   " FOR VALUES FROM (" + std::to_string(lo) + ") TO (" + std::to_string(hi) + ")");
+            if (!exists)
+                std::cout << "[PARTITION] Attached " << name << "\n";
+            else if (keep_existing)
+                std::cout << "[PARTITION] Merged " << name << " (" << kept << " existing rows kept)\n";
+            else
+                std::cout << "[PARTITION] Replaced " << name << "\n";
+        }
+
+        W.commit();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[DB ERROR] attach_partitions failed: " << e.what() << "\n";
+        throw;
+    }
+}
+
+// =============================================================================
+// METHOD 16: freeze_load()
+// =============================================================================
+// PURPOSE: Full reload of trades with COPY ... WITH (FREEZE).
+//
+// WHAT FREEZE SAVES:
+//   A normally COPYed row carries the loading transaction's ID (xmin). The
+//   first reader must look that ID up in the commit log and then REWRITE the
+//   page to set "hint bits" — so the first SELECT after a load dirties every
+//   page. Later, VACUUM must visit every page again to FREEZE the rows before
+//   transaction-ID wraparound. For a 1M-row nightly table that is two extra
+//   full passes of write I/O.
+//   FREEZE writes the rows already frozen and visible: no hint-bit rewrite,
+//   no freeze VACUUM. The load is the ONLY write the pages ever get.
+//
+// THE RULE: PostgreSQL only allows FREEZE when the table was CREATED or
+// TRUNCATED in the same transaction as the COPY (so no other transaction can
+// have seen the table's old contents). Hence BEGIN → TRUNCATE → COPY FREEZE
+// → COMMIT on one connection — which also means ONE COPY stream for the
+// monolithic trades table. For parallel FREEZE loads use trades_daily: each
+// day's table is created inside its own COPY transaction (METHOD 17).
+// =============================================================================
+
+// Send pieces through one AsyncCopyWriter: rows are encoded into large
+// blocks while the previous block drains (METHOD 18), then the COPY ends.
+static CopyStreamStats stream_pieces(PgCopyStream& copy,
+                                     const std::vector<std::span<const Trade>>& pieces)
+{
+    AsyncCopyWriter writer(copy);
+    for (const auto& piece : pieces)
+        for (const auto& t : piece)
+            writer.write(t);
+    const long long rows = writer.finish();
+    CopyStreamStats stats = writer.stats();
+    stats.rows = rows; // the server's count, not ours
+    return stats;
+}
+
+long long DatabaseLoader::freeze_load(std::span<const Trade> trades)
+{
+    try
+    {
+        PgCopyStream copy(conn_str);
+        copy.exec("BEGIN");
+        copy.exec("TRUNCATE TABLE trades");
+        copy.exec("ALTER TABLE trades DROP CONSTRAINT IF EXISTS trades_pkey");
+        copy.exec("DROP INDEX IF EXISTS idx_trades_symbol_time");
+        copy.exec("DROP INDEX IF EXISTS trades_pkey_build");
+
+        copy.begin_copy(std::string("COPY trades ") + CopyRowEncoder::COLUMNS +
+                        " FROM STDIN WITH (FREEZE)");
+        const long long rows = stream_pieces(copy, {trades}).rows;
+        copy.exec("COMMIT");
+
+        std::cout << "[DB] COPY FREEZE complete: " << rows << " rows (truncate + load, one transaction)\n";
+        return rows;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[DB ERROR] freeze_load failed: " << e.what() << "\n";
+        throw;
+    }
+}
+
+// =============================================================================
+// METHOD 17: copy_partition_freeze()
+// =============================================================================
+// Same idea per day: the load table is CREATED inside the COPY transaction,
+// so COPY FREEZE is allowed. Each day runs on its own connection — days load
+// in parallel, each as one frozen stream. Indexes and ATTACH follow exactly
+// as in the non-freeze path (METHOD 14, 15).
+// =============================================================================
+long long DatabaseLoader::copy_partition_freeze(long long day,
+                                                const std::vector<std::span<const Trade>>& pieces)
+{
+    try
+    {
+        PgCopyStream copy(conn_str);
+        copy.exec("BEGIN");
+        for (const auto& sql : partition_load_ddl(day))
+            copy.exec(sql);
+
+        copy.begin_copy("COPY " + partition_load_table(day) + " " + CopyRowEncoder::COLUMNS +
+                        " FROM STDIN WITH (FREEZE)");
+        const long long rows = stream_pieces(copy, pieces).rows;
+        copy.exec("COMMIT");
+        return rows;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[DB ERROR] copy_partition_freeze (" << partition_name(day)
+                  << ") failed: " << e.what() << "\n";
+        throw;
+    }
+}
+
+// =============================================================================
+// METHOD 18: copy_chunk_async() / parse_copy_engine()
+// =============================================================================
+// Same job as copy_chunk() (METHOD 5): one connection, one transaction, one
+// COPY stream of this thread's slice. The difference is HOW rows travel:
+//
+//   stream_to:  row → tuple → escape → libpq buffer → blocking send
+//               (thread sleeps whenever the socket is full)
+//   async:      rows → 256 KB block ─► PQputCopyData ─► non-blocking PQflush
+//               while the next block is already being encoded
+//
+// The returned stats let ParallelLoader print MB/s and socket-wait per
+// stream for both engines side by side.
+// =============================================================================
+CopyStreamStats DatabaseLoader::copy_chunk_async(std::span<const Trade> chunk, int thread_id,
+                                                 const std::string& table)
+{
+    if (chunk.empty()) return {};
+
+    try
+    {
+        PgCopyStream copy(conn_str);
+        copy.exec("BEGIN");
+        copy.begin_copy("COPY " + table + " " + CopyRowEncoder::COLUMNS + " FROM STDIN");
+        const CopyStreamStats stats = stream_pieces(copy, {chunk});
+        copy.exec("COMMIT");
+        return stats;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[DB ERROR] copy_chunk_async (thread " << thread_id
+                  << ") failed: " << e.what() << "\n";
+        throw;
+    }
+}
+
+CopyStreamStats DatabaseLoader::copy_chunk_async(const std::vector<std::span<const Trade>>& pieces,
+                                                 int thread_id, const std::string& table)
+{
+    try
+    {
+        PgCopyStream copy(conn_str);
+        copy.exec("BEGIN");
+        copy.begin_copy("COPY " + table + " " + CopyRowEncoder::COLUMNS + " FROM STDIN");
+        const CopyStreamStats stats = stream_pieces(copy, pieces);
+        copy.exec("COMMIT");
+        return stats;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[DB ERROR] copy_chunk_async (thread " << thread_id
+                  << ") failed: " << e.what() << "\n";
+        throw;
+    }
+}
+
+CopyEngine DatabaseLoader::parse_copy_engine(std::string_view name)
+{
+    if (name == "stream_to") return CopyEngine::StreamTo;
+    if (name == "async")     return CopyEngine::Async;
+    throw std::invalid_argument("Unknown COPY engine '" + std::string(name) +
+                                "' (expected stream_to | async)");
+}
+
+const char* DatabaseLoader::copy_engine_name(CopyEngine engine)
+{
+    return engine == CopyEngine::Async ? "async" : "stream_to";
+}
+
+// =============================================================================
+// METHOD 19: extract_bounds() / extract_range()
+// =============================================================================
+// PURPOSE: pull a (symbol set, time range) back out of trades for backfills —
+//          re-running indicators, rewriting Parquet — without psql scripts.
+//
+//   COPY (SELECT <9 columns> FROM trades
+//         WHERE timestamp >= from AND timestamp < to AND symbol IN (...))
+//   TO STDOUT (FORMAT BINARY)
+//
+// WHY COPY AND NOT SELECT?
+//   A SELECT result is materialized in full (libpq buffers every row before
+//   returning) and every value arrives as text. COPY streams: rows are
+//   decoded while the server is still producing the rest, memory stays at
+//   one batch.
+//
+// WHY BINARY?
+//   See CopyBinaryDecoder — no float printing on the server, no parsing here.
+//
+// WHY extract_bounds()?
+//   ParallelExtractor splits the range into time slices, one COPY each.
+//   Splitting [INT64_MIN, INT64_MAX) evenly would put every row in one slice;
+//   splitting the ACTUAL [min, max] of the matching rows does not.
+//
+// WHY export_snapshot()?
+//   Each slice runs on its own connection — by default, its own snapshot.
+//   A load committing between two slices would show up in one and not the
+//   other: an extract matching no single point in time. With query.snapshot
+//   set, the bounds and every slice run REPEATABLE READ on the SAME exported
+//   snapshot (SET TRANSACTION SNAPSHOT), so concurrent loads are invisible.
+//
+// table, symbols and snapshot are pasted into the SQL text (COPY takes no
+// bind parameters): table is whitelisted, the others are character-checked.
+// =============================================================================
+
+static const std::string& extract_table(const ExtractQuery& query)
+{
+    if (query.table != "trades" && query.table != "trades_daily")
+        throw std::invalid_argument("Invalid extract table '" + query.table + "' (trades or trades_daily)");
+    return query.table;
+}
+
+// Snapshot ids look like "00000003-0000001B-1"
+static std::string set_snapshot_sql(const std::string& id)
+{
+    const bool ok = !id.empty() && std::all_of(id.begin(), id.end(), [](char c)
+        { return std::isxdigit(static_cast<unsigned char>(c)) || c == '-'; });
+    if (!ok)
+        throw std::invalid_argument("Invalid snapshot id '" + id + "'");
+    return "SET TRANSACTION SNAPSHOT '" + id + "'";
+}
+
+DatabaseLoader::ExtractSnapshot DatabaseLoader::export_snapshot()
+{
+    try
+    {
+        ExtractSnapshot snapshot;
+        snapshot.holder = std::make_unique<PgCopyStream>(conn_str);
+        snapshot.holder->exec("BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY");
+        // COPY OUT: PgCopyStream reads rows only through COPY
+        snapshot.holder->begin_copy_out("COPY (SELECT pg_export_snapshot()) TO STDOUT");
+        for (std::string_view row = snapshot.holder->get(); !row.empty(); row = snapshot.holder->get())
+        {
+            while (!row.empty() && (row.back() == '\n' || row.back() == '\r'))
+                row.remove_suffix(1);
+            snapshot.id.assign(row);
+        }
+        set_snapshot_sql(snapshot.id); // validates
+        return snapshot;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[DB ERROR] export_snapshot failed: " << e.what() << "\n";
+        throw;
+    }
+}
+
+// Only characters that can appear in a ticker are accepted in symbols.
+static std::string extract_where(const ExtractQuery& query)
+{
+    std::vector<std::string> conditions;
+    if (query.from_ns != std::numeric_limits<long long>::min())
+        conditions.push_back("timestamp >= " + std::to_string(query.from_ns));
+    if (query.to_ns != std::numeric_limits<long long>::max())
+        conditions.push_back("timestamp < " + std::to_string(query.to_ns));
+    if (!query.symbols.empty())
+    {
+        std::string in = "symbol IN (";
+        for (size_t i = 0; i < query.symbols.size(); ++i)
+        {
+            const std::string& sym = query.symbols[i];
+            const bool ok = !sym.empty() && std::all_of(sym.begin(), sym.end(), [](char c)
+                { return std::isalnum(static_cast<unsigned char>(c)) || c == '.' || c == '-' || c == '_' || c == '&'; });
+            if (!ok)
+                throw std::invalid_argument("Invalid extract symbol '" + sym + "'");
+            in += (i ? ", '" : "'") + sym + "'";
+        }
+        conditions.push_back(in + ")");
+    }
+
+    std::string where;
+    for (const auto& c : conditions)
+        where += (where.empty() ? " WHERE " : " AND ") + c;
+    return where;
+}
+
+std::pair<long long, long long> DatabaseLoader::extract_bounds(const ExtractQuery& query)
+{
+    try
+    {
+        pqxx::connection C(conn_str);
+        pqxx::work W(C);
+
+        if (!query.snapshot.empty())
+        {
+            W.exec("SET TRANSACTION ISOLATION LEVEL REPEATABLE READ");
+            W.exec(set_snapshot_sql(query.snapshot));
+        }
+        const std::string where = extract_where(query);
+        const std::string& table = extract_table(query);
+        const auto lo = W.query_value<long long>(
+            "SELECT COALESCE(MIN(timestamp), 0) FROM " + table + where);
+        const auto hi = W.query_value<long long>(
+            "SELECT COALESCE(MAX(timestamp), -1) FROM " + table + where);
+        W.commit();
+        return {lo, hi};
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[DB ERROR] extract_bounds failed: " << e.what() << "\n";
+        throw;
+    }
+}
+
+CopyStreamStats DatabaseLoader::extract_range(const ExtractQuery& query, const TradeBatchFn& on_batch,
+                                              size_t batch_rows)
+{
+    try
+    {
+        const std::string sql = std::string("COPY (SELECT ") + CopyBinaryDecoder::COLUMNS +
+                                " FROM " + extract_table(query) + extract_where(query) +
+                                ") TO STDOUT (FORMAT BINARY)";
+        PgCopyStream copy(conn_str);
+        const auto t0 = std::chrono::steady_clock::now();
+        if (!query.snapshot.empty())
+        {
+            copy.exec("BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY");
+            copy.exec(set_snapshot_sql(query.snapshot));
+        }
+        copy.begin_copy_out(sql);
+
+        CopyStreamStats stats;
+        CopyBinaryDecoder decoder;
+        std::vector<Trade> batch;
+        batch.reserve(batch_rows);
+
+        auto hand_off = [&]()
+        {
+            stats.rows += static_cast<long long>(batch.size());
+            on_batch(std::move(batch));
+            batch = {};
+            batch.reserve(batch_rows);
+        };
+
+        for (;;)
+        {
+            const auto w0 = std::chrono::steady_clock::now();
+            const std::string_view block = copy.get();
+            stats.wait_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                 std::chrono::steady_clock::now() - w0).count();
+            if (block.empty())
+                break;
+            stats.bytes += static_cast<long long>(block.size());
+            decoder.feed(block, batch);
+            if (batch.size() >= batch_rows)
+                hand_off();
+        }
+        if (!decoder.finished())
+            throw std::runtime_error("[EXTRACT] COPY ended without the binary trailer");
+        if (!batch.empty())
+            hand_off();
+        if (!query.snapshot.empty())
+            copy.exec("COMMIT");
+
+        stats.total_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - t0).count();
+        return stats;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[DB ERROR] extract_range failed: " << e.what() << "\n";
         throw;
     }
 }
 
-} // namespace MarketStream
\ No newline at end of file
+} // namespace MarketStream
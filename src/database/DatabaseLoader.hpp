@@ -3,13 +3,72 @@
 #include <string>
 #include <vector>
 #include <span> // C++20: zero-copy slice view
+#include <string_view>
+#include <functional> // std::function — extract batch callback
+#include <utility>    // std::pair — extract_bounds()
+#include <limits>
+#include <memory>     // std::unique_ptr — ExtractSnapshot holder
 #include <pqxx/pqxx>
 #include "../model/Trade.hpp"
+#include "CopyStream.hpp"
 #include "../indicators/TechnicalIndicators.hpp"
+#include "../indicators/OrderFlow.hpp"
+#include "../indicators/OrderAggregator.hpp"
 
 namespace MarketStream
 {
 
+    // How a batch of trades reaches the trades table (see ParallelLoader::run).
+    //   Replace       — TRUNCATE, drop indexes, parallel COPY, rebuild (nightly file)
+    //   Append        — parallel COPY into UNLOGGED staging, then
+    //                   INSERT ... ON CONFLICT DO NOTHING with indexes in place
+    //   AppendRebuild — staging as above, but drop indexes, merge, rebuild
+    //                   (a delta too large for per-row index maintenance)
+    //   Auto          — Replace on an empty table, otherwise Append or
+    //                   AppendRebuild depending on delta size vs table size
+    //   Freeze        — TRUNCATE + COPY ... WITH (FREEZE) in ONE transaction:
+    //                   rows are written frozen, no post-load VACUUM/hint-bit
+    //                   I/O. One stream per table (per day when partitioned).
+    enum class LoadMode
+    {
+        Replace,
+        Append,
+        AppendRebuild,
+        Auto,
+        Freeze
+    };
+
+    // How each COPY stream sends its rows (ETL_COPY_ENGINE).
+    //   StreamTo — pqxx::stream_to, one tuple at a time, blocking sends
+    //   Async    — AsyncCopyWriter: encode block N+1 while block N is flushed
+    //              by non-blocking libpq (see CopyStream.hpp)
+    enum class CopyEngine
+    {
+        StreamTo,
+        Async
+    };
+
+    // Which rows an extract pulls back out of the database (METHOD 19)
+    struct ExtractQuery
+    {
+        std::string table = "trades";     // or trades_daily (partitions pruned by the range) — nothing else
+        std::vector<std::string> symbols; // empty = every symbol
+        long long from_ns = std::numeric_limits<long long>::min(); // inclusive
+        long long to_ns = std::numeric_limits<long long>::max();   // exclusive
+        // pg_export_snapshot() id (DatabaseLoader::export_snapshot());
+        // empty = the statement's own snapshot
+        std::string snapshot;
+    };
+
+    // Wall time of each step of finalize_parallel_load() (for bench_results)
+    struct IndexBuildTimings
+    {
+        long long primary_key_ns = 0; // CREATE UNIQUE INDEX (trade_id)
+        long long symbol_time_ns = 0; // CREATE INDEX (symbol, timestamp)
+        long long attach_pk_ns = 0;   // ADD PRIMARY KEY USING INDEX
+        long long wall_ns = 0;        // Whole finalize (builds overlap)
+    };
+
     class DatabaseLoader
     {
     public:
@@ -18,7 +77,7 @@ namespace MarketStream
 
         // ── Existing methods (unchanged) ──────────────────────────────────
 
-        // Creates both tables: 'trades' and 'technical_indicators'
+        // Creates the tables: 'trades', 'technical_indicators', 'order_flow', 'order_fills'
         void init_schema();
 
         // Single-connection bulk load (staging table + ON CONFLICT pattern)
@@ -28,6 +87,13 @@ namespace MarketStream
         // Saves computed indicators to technical_indicators table
         void save_indicators(const std::vector<IndicatorResult> &indicators);
 
+        // Saves per-(symbol, bucket) order-flow aggregates to order_flow table
+        void save_order_flow(const std::vector<OrderFlowBucket> &buckets);
+
+        // Replaces order_fills with per-order aggregates (TRUNCATE + COPY);
+        // merge = true adds them to the existing rows instead (append loads)
+        void save_order_fills(const std::vector<OrderFill> &fills, bool merge = false);
+
         // ── Phase 9: Parallel COPY methods (call in this exact order) ────
         //
         // USAGE:
@@ -46,10 +112,128 @@ namespace MarketStream
 
         // Step 2 (parallel): COPY one chunk of trades directly into trades table
         // Each thread calls this with its own DatabaseLoader instance (= own connection)
-        void copy_chunk(std::span<const Trade> chunk, int thread_id);
+        // table defaults to "trades"; append loads pass STAGING_TABLE
+        void copy_chunk(std::span<const Trade> chunk, int thread_id,
+                        const std::string &table = "trades");
+
+        // Same, for rows that are not contiguous (e.g. one day's trades after
+        // a symbol sort): all pieces go through ONE COPY stream.
+        void copy_chunk(const std::vector<std::span<const Trade>> &pieces, int thread_id,
+                        const std::string &table);
+
+        // Step 2, CopyEngine::Async: same contract as copy_chunk(), returns
+        // the stream's byte count and socket-wait time
+        CopyStreamStats copy_chunk_async(std::span<const Trade> chunk, int thread_id,
+                                         const std::string &table = "trades");
+        CopyStreamStats copy_chunk_async(const std::vector<std::span<const Trade>> &pieces,
+                                         int thread_id, const std::string &table);
+
+        // "stream_to" | "async"
+        static CopyEngine parse_copy_engine(std::string_view name);
+        static const char *copy_engine_name(CopyEngine engine);
+
+        // Step 3: Rebuild PRIMARY KEY and index after all chunks loaded.
+        // Both indexes are built CONCURRENTLY on two connections; the PK is
+        // then attached from the pre-built unique index.
+        IndexBuildTimings finalize_parallel_load(size_t total_rows);
+
+        // Session settings applied before every bulk index build
+        static constexpr const char *INDEX_BUILD_WORK_MEM = "512MB";
+        static constexpr int INDEX_BUILD_PARALLEL_WORKERS = 2;
+
+        // ── Append loads (intraday deltas, existing rows kept) ───────────
+        //
+        // USAGE (same 3-step shape, different table):
+        //   LoadMode m = loader.resolve_load_mode(LoadMode::Auto, delta.size());
+        //   loader.prepare_for_append_load();
+        //   // ... N threads: copy_chunk(chunk, id, STAGING_TABLE) ...
+        //   loader.finalize_append_load(m == LoadMode::AppendRebuild);
+
+        static constexpr const char *STAGING_TABLE = "trades_staging";
+
+        // Delta/table ratio above which Auto picks AppendRebuild over Append
+        static constexpr double APPEND_REBUILD_RATIO = 0.2;
+
+        // "replace" | "append" | "append-rebuild" | "auto" | "freeze" (ETL_LOAD_MODE)
+        static LoadMode parse_load_mode(std::string_view name);
+        static const char *load_mode_name(LoadMode mode);
+
+        // Turns Auto into a concrete mode using the planner's row estimate;
+        // Replace only after an EXISTS probe confirms the table is empty
+        LoadMode resolve_load_mode(LoadMode requested, size_t delta_rows);
+
+        // Step 1: create (if needed) and empty the UNLOGGED staging table
+        void prepare_for_append_load();
+
+        // Step 3: merge staging into trades in ONE transaction; returns rows inserted
+        size_t finalize_append_load(bool rebuild_indexes);
+
+        // ── Daily partitions: trades_daily (see PartitionedLoader) ───────
+        //
+        // USAGE:
+        //   prepare_partition_load(days);                 // main thread
+        //   // N threads: copy_chunk(pieces, id, partition_load_table(day))
+        //   // 2 per day: build_partition_index(day, true / false)
+        //   attach_partitions(days, keep_existing);       // main thread
+
+        static constexpr long long NS_PER_DAY = 86'400'000'000'000LL;
+
+        // Day number (days since 1970-01-01 UTC) → "trades_daily_20231025"
+        static std::string partition_name(long long day);
+        static std::string partition_load_table(long long day);
+
+        // Create an empty, unattached load table per day (CHECK on its range)
+        void prepare_partition_load(const std::vector<long long> &days);
+
+        // primary = unique (trade_id, timestamp) index, else (symbol, timestamp)
+        void build_partition_index(long long day, bool primary);
+
+        // Swap every day's load table in as its partition, in ONE transaction.
+        // keep_existing = merge the day's current rows in first (append
+        // modes); false = the batch replaces each day it covers
+        void attach_partitions(const std::vector<long long> &days, bool keep_existing);
+
+        // ── COPY FREEZE (LoadMode::Freeze) ───────────────────────────────
+        // Both run on a raw libpq connection (CopyStream.hpp): pqxx cannot
+        // send COPY options.
+
+        // TRUNCATE trades + drop indexes + COPY FREEZE, one transaction.
+        // Follow with finalize_parallel_load(). Returns rows loaded.
+        long long freeze_load(std::span<const Trade> trades);
+
+        // CREATE the day's load table + COPY FREEZE into it, one transaction.
+        // Replaces prepare_partition_load() + copy_chunk() for that day.
+        long long copy_partition_freeze(long long day,
+                                        const std::vector<std::span<const Trade>> &pieces);
+
+        // ── Extracts: COPY (SELECT ...) TO STDOUT (FORMAT BINARY) ────────
+        //
+        // USAGE (ParallelExtractor does this across N connections):
+        //   auto [lo, hi] = loader.extract_bounds(query);   // split [lo, hi]
+        //   // N threads: extract_range(slice_query, on_batch)
+
+        using TradeBatchFn = std::function<void(std::vector<Trade> &&batch)>;
+        static constexpr size_t EXTRACT_BATCH_ROWS = 65'536;
+
+        // One point in time for a multi-connection extract: a REPEATABLE READ
+        // transaction on its own connection exports its snapshot; each slice
+        // imports it (ExtractQuery::snapshot). Keep `holder` open until every
+        // slice has started — the snapshot dies with the exporting transaction.
+        struct ExtractSnapshot
+        {
+            std::unique_ptr<PgCopyStream> holder;
+            std::string id;
+        };
+        ExtractSnapshot export_snapshot();
+
+        // Smallest / largest timestamp of the matching rows; {0, -1} if none
+        std::pair<long long, long long> extract_bounds(const ExtractQuery &query);
 
-        // Step 3 (sequential): Rebuild PRIMARY KEY and index after all chunks loaded
-        void finalize_parallel_load(size_t total_rows);
+        // Stream the matching rows out in binary and decode them into batches
+        // of up to batch_rows. on_batch runs on the calling thread.
+        // stats.bytes = binary bytes received, wait_ns = blocked on the server
+        CopyStreamStats extract_range(const ExtractQuery &query, const TradeBatchFn &on_batch,
+                                      size_t batch_rows = EXTRACT_BATCH_ROWS);
 
     private:
         std::string conn_str;
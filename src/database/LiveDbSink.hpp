@@ -0,0 +1,330 @@
+#pragma once
+
+// ============================================================================
+// LiveDbSink — Persist live ticks with bounded latency (micro-batched COPY)
+// ============================================================================
+//
+// WHY MICRO-BATCHES?
+// One INSERT per tick = one round trip + one commit (WAL fsync) per tick:
+// a few thousand ticks/sec at best. One COPY per FILE (ParallelLoader) has
+// unbounded latency — nothing is durable until the file ends.
+// Micro-batching sits in between:
+//
+//   consumer ──offer()──► SPSCQueue ──► sink thread: encode rows into a block
+//                                          │
+//                   flush when ROWS ≥ batch_rows   (throughput bound)
+//                       or OLDEST ≥ max_batch_age  (latency bound)
+//                                          │
+//                              COPY trades_live FROM STDIN
+//                              on ONE persistent connection
+//
+// A standalone COPY is its own transaction: when end_copy() returns, the
+// batch is committed. End-to-end latency of a tick is therefore at most
+//   max_batch_age (waiting for the batch) + commit latency (the COPY itself)
+//
+// ADAPTIVE BATCH SIZE (AIMD — the TCP congestion-control rule):
+//   commit latency > target  → batch_rows /= 2        (multiplicative decrease)
+//   batch filled by SIZE and
+//   commit latency ≤ target  → batch_rows += step     (additive increase)
+// Bigger batches amortize the per-COPY round trip and commit; the latency
+// target stops them growing until one COPY eats the whole latency budget.
+// Age-triggered flushes never grow the batch: the feed is slower than the
+// batch, so a bigger one would only wait longer.
+//
+// WHY A SECOND QUEUE (and not the TickClient queue directly)?
+// SPSCQueue has exactly one consumer — the thread running the feed logic.
+// That thread forwards each processed tick with offer(); the sink thread is
+// the single consumer of ITS queue. A slow database stalls offer() (counted
+// in stats().stalls) — backpressure, not data loss.
+//
+// TABLE: trades_live — trades' columns without the PRIMARY KEY. A live feed
+// can replay a tick after a reconnect; an append-only table takes the row
+// instead of failing the whole batch. The (symbol, timestamp) index stays.
+//
+// CRASH REPLAY: ticks committed before a crash are still in the journal.
+// committed_keys() reads back the (trade_id, timestamp) keys already in the
+// table for the journal's time range, and the replay skips those — exact even
+// though ticks reach the sink reordered and spread over shard sinks, where a
+// "highest journal seq committed" watermark would lose the held-back ones.
+// ============================================================================
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+#include <unordered_set>
+#include <charconv>
+#include "CopyStream.hpp"
+#include "../threading/SPSCQueue.hpp"
+#include "../threading/ThreadPlacement.hpp"
+#include "../model/Trade.hpp"
+
+namespace MarketStream
+{
+
+    struct LiveSinkConfig
+    {
+        std::string table = "trades_live";
+        size_t initial_batch_rows = 10'000;
+        size_t min_batch_rows = 1'000;
+        size_t max_batch_rows = 100'000;
+        size_t batch_rows_step = 1'000; // additive increase
+        std::chrono::milliseconds max_batch_age{50};
+        std::chrono::milliseconds target_commit_latency{20};
+        // synchronous_commit = off: the COPY returns before its WAL is flushed.
+        // Lower commit latency; a crash can lose the last ~0.6s of ticks.
+        bool async_commit = false;
+    };
+
+    struct LiveSinkStats
+    {
+        size_t rows = 0;         // committed
+        size_t batches = 0;
+        size_t size_flushes = 0; // batch reached batch_rows
+        size_t age_flushes = 0;  // oldest tick reached max_batch_age
+        size_t failed_rows = 0;  // lost with a failed COPY
+        size_t stalls = 0;       // offer() found the queue full
+        size_t batch_rows = 0;   // current adaptive target
+        long long max_commit_ns = 0;
+        long long p99_latency_ns = 0; // offer() of a batch's oldest tick → commit
+        long long max_latency_ns = 0;
+    };
+
+    // (trade_id, timestamp) — a row's identity for crash-replay dedupe
+    struct LiveRowKey
+    {
+        uint64_t trade_id = 0;
+        long long timestamp = 0;
+        bool operator==(const LiveRowKey &) const = default;
+    };
+
+    struct LiveRowKeyHash
+    {
+        size_t operator()(const LiveRowKey &k) const noexcept
+        {
+            return std::hash<uint64_t>{}(k.trade_id * 0x9E3779B97F4A7C15ULL ^ static_cast<uint64_t>(k.timestamp));
+        }
+    };
+
+    class LiveDbSink
+    {
+    public:
+        using CommittedKeys = std::unordered_set<LiveRowKey, LiveRowKeyHash>;
+
+        // 65536 slots ≈ 330 ms of slack at 200K ticks/s while a COPY is running
+        static constexpr size_t QUEUE_CAPACITY = 65536;
+
+        explicit LiveDbSink(std::string conn_str, LiveSinkConfig config = {})
+            : conn_str_(std::move(conn_str)), config_(std::move(config)),
+              queue_(std::make_unique<Queue>())
+        {
+            batch_rows_ = config_.initial_batch_rows;
+        }
+
+        ~LiveDbSink() { stop(); }
+
+        LiveDbSink(const LiveDbSink &) = delete;
+        LiveDbSink &operator=(const LiveDbSink &) = delete;
+
+        // Connects and creates the table on the CALLING thread (errors throw
+        // here, not later on the sink thread), then starts the sink thread.
+        void start()
+        {
+            connect();
+            running_.store(true, std::memory_order_release);
+            thread_ = std::thread([this]()
+                                  {
+                                      // Off the consumer's core (it started us)
+                                      ThreadPlacement::apply(ThreadRole::Helper);
+                                      run(); });
+        }
+
+        // Drains everything already offered, flushes, joins.
+        void stop()
+        {
+            if (!running_.exchange(false, std::memory_order_acq_rel))
+                return;
+            if (thread_.joinable())
+                thread_.join();
+            finish_stats();
+        }
+
+        // Producer side — call from ONE thread only (SPSC contract)
+        void offer(const Trade &t)
+        {
+            Pending p{t, std::chrono::steady_clock::now()};
+            if (queue_->try_push(std::move(p)))
+                return;
+            ++stats_.stalls;
+            while (!queue_->try_push(std::move(p)))
+                std::this_thread::yield();
+        }
+
+        // Valid after stop()
+        [[nodiscard]] const LiveSinkStats &stats() const { return stats_; }
+
+        // ====================================================================
+        // committed_keys() — keys already in the table for [from_ts, to_ts]
+        // ====================================================================
+        // Call after start() (the table exists). Runs on its OWN connection,
+        // so it never touches the sink thread's. Text COPY OUT: one row per
+        // get(), "trade_id\ttimestamp\n".
+        // ====================================================================
+        [[nodiscard]]
+        CommittedKeys committed_keys(long long from_ts, long long to_ts) const
+        {
+            CommittedKeys keys;
+            PgCopyStream conn(conn_str_);
+            conn.begin_copy_out("COPY (SELECT trade_id, timestamp FROM " + config_.table +
+                                " WHERE timestamp BETWEEN " + std::to_string(from_ts) + " AND " +
+                                std::to_string(to_ts) + ") TO STDOUT");
+            for (std::string_view row = conn.get(); !row.empty(); row = conn.get())
+            {
+                LiveRowKey k;
+                const char *end = row.data() + row.size();
+                auto [p, ec] = std::from_chars(row.data(), end, k.trade_id);
+                if (ec == std::errc() && p < end && *p == '\t')
+                    ec = std::from_chars(p + 1, end, k.timestamp).ec;
+                if (ec == std::errc())
+                    keys.insert(k);
+            }
+            return keys;
+        }
+
+    private:
+        struct Pending
+        {
+            Trade trade;
+            std::chrono::steady_clock::time_point offered;
+        };
+        using Queue = SPSCQueue<Pending, QUEUE_CAPACITY>;
+        enum class Trigger
+        {
+            Size,
+            Age,
+            Drain
+        };
+
+        void connect()
+        {
+            conn_ = std::make_unique<PgCopyStream>(conn_str_);
+            conn_->exec("CREATE TABLE IF NOT EXISTS " + config_.table + R"( (
+                trade_id  BIGINT           NOT NULL,
+                order_id  BIGINT           NOT NULL,
+                timestamp BIGINT           NOT NULL,
+                symbol    VARCHAR(10)      NOT NULL,
+                price     DOUBLE PRECISION NOT NULL CHECK (price > 0),
+                volume    INTEGER          NOT NULL CHECK (volume > 0),
+                side      CHAR(1)          NOT NULL CHECK (side IN ('B','S','N')),
+                type      CHAR(1)          NOT NULL CHECK (type IN ('M','L','I')),
+                is_pro    BOOLEAN          NOT NULL
+            ))");
+            conn_->exec("CREATE INDEX IF NOT EXISTS idx_" + config_.table + "_symbol_time ON " +
+                        config_.table + " (symbol, timestamp)");
+            if (config_.async_commit)
+                conn_->exec("SET synchronous_commit = off");
+        }
+
+        // ── Sink thread ──────────────────────────────────────────────────────
+        void run()
+        {
+            block_.reserve(1 << 20);
+            while (running_.load(std::memory_order_acquire) || !queue_->empty())
+            {
+                auto item = queue_->try_pop();
+                const auto now = std::chrono::steady_clock::now();
+                if (item)
+                {
+                    if (batch_count_ == 0)
+                        batch_oldest_ = item->offered;
+                    CopyRowEncoder::append(block_, item->trade);
+                    ++batch_count_;
+                    if (batch_count_ >= batch_rows_)
+                    {
+                        flush(Trigger::Size);
+                        continue;
+                    }
+                }
+                if (batch_count_ > 0 && now - batch_oldest_ >= config_.max_batch_age)
+                    flush(Trigger::Age);
+                else if (!item)
+                    std::this_thread::yield(); // queue empty, batch still young
+            }
+            if (batch_count_ > 0)
+                flush(Trigger::Drain);
+        }
+
+        void flush(Trigger trigger)
+        {
+            const auto t0 = std::chrono::steady_clock::now();
+            try
+            {
+                if (!conn_)
+                    connect(); // previous COPY failed — fresh connection
+                conn_->begin_copy("COPY " + config_.table + " " + CopyRowEncoder::COLUMNS + " FROM STDIN");
+                conn_->put(block_);
+                conn_->end_copy(); // autocommit: returns once committed
+                stats_.rows += batch_count_;
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << "[LIVE-DB ERROR] Batch of " << batch_count_ << " rows lost: " << e.what() << "\n";
+                stats_.failed_rows += batch_count_;
+                conn_.reset();
+            }
+            const auto t1 = std::chrono::steady_clock::now();
+            const long long commit_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+            latencies_.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - batch_oldest_).count());
+
+            ++stats_.batches;
+            stats_.max_commit_ns = std::max(stats_.max_commit_ns, commit_ns);
+            if (trigger == Trigger::Size)
+                ++stats_.size_flushes;
+            else if (trigger == Trigger::Age)
+                ++stats_.age_flushes;
+
+            // ── AIMD ─────────────────────────────────────────────────────────
+            const long long target_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                            config_.target_commit_latency)
+                                            .count();
+            if (commit_ns > target_ns)
+                batch_rows_ = std::max(config_.min_batch_rows, batch_rows_ / 2);
+            else if (trigger == Trigger::Size)
+                batch_rows_ = std::min(config_.max_batch_rows, batch_rows_ + config_.batch_rows_step);
+
+            block_.clear();
+            batch_count_ = 0;
+        }
+
+        void finish_stats()
+        {
+            stats_.batch_rows = batch_rows_;
+            if (latencies_.empty())
+                return;
+            std::sort(latencies_.begin(), latencies_.end());
+            stats_.max_latency_ns = latencies_.back();
+            stats_.p99_latency_ns = latencies_[(latencies_.size() - 1) * 99 / 100];
+        }
+
+        std::string conn_str_;
+        LiveSinkConfig config_;
+        std::unique_ptr<Queue> queue_; // ~7 MB — heap, not stack
+        std::unique_ptr<PgCopyStream> conn_;
+        std::atomic<bool> running_{false};
+        std::thread thread_;
+
+        // Sink-thread state
+        std::string block_;
+        size_t batch_count_ = 0;
+        size_t batch_rows_ = 0;
+        std::chrono::steady_clock::time_point batch_oldest_;
+        std::vector<long long> latencies_; // one per batch: its oldest tick
+
+        LiveSinkStats stats_; // stalls: producer thread; the rest: sink thread
+    };
+
+} // namespace MarketStream
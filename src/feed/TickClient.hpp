@@ -21,6 +21,15 @@
 // The consumer doesn't care about network timing.
 // The SPSCQueue absorbs the timing mismatch between them.
 //
+// SHARDED MODE (one queue per consumer):
+//   TickClient ──hash(symbol)──┬──► SPSCQueue 0 ──► Consumer 0  (symbols A, D, …)
+//                              ├──► SPSCQueue 1 ──► Consumer 1  (symbols B, E, …)
+//                              └──► SPSCQueue N ──► Consumer N
+// A symbol always hashes to the same queue, and each queue is FIFO — so
+// per-symbol order is exactly the arrival order, as with one queue. Every
+// consumer owns its symbols' state outright: no locks, no shared lines, and
+// still one producer + one consumer per queue (the SPSC contract holds).
+//
 // WHY A SEPARATE THREAD FOR THE CLIENT?
 // ws.read() is BLOCKING — it waits until a message arrives.
 // If we ran it on the main thread, main would be stuck waiting.
@@ -35,10 +44,15 @@
 #include <thread>
 #include <atomic>
 #include <iostream>
+#include <vector>
+#include <stdexcept>
 
 #include "../feed/TickMessage.hpp"
+#include "../feed/TickJournal.hpp"
 #include "../threading/SPSCQueue.hpp"
+#include "../threading/ThreadPlacement.hpp"
 #include "../model/Trade.hpp"
+#include "../model/SymbolKey.hpp"
 
 namespace beast = boost::beast;
 namespace websocket = beast::websocket;
@@ -73,13 +87,29 @@ namespace MarketStream
         explicit TickClient(TradeQueue &queue,
                             std::string host = "localhost",
                             std::string port = "9002")
-            : queue_(queue),
+            : TickClient(std::vector<TradeQueue *>{&queue}, std::move(host), std::move(port))
+        {
+        }
+
+        // ========================================================================
+        // Sharded constructor — one queue per consumer
+        // ========================================================================
+        // queues[i] is drained by consumer i; tick → queues[shard_of(symbol)].
+        // The queues must outlive the client. One queue = the constructor above.
+        // ========================================================================
+        explicit TickClient(std::vector<TradeQueue *> queues,
+                            std::string host = "localhost",
+                            std::string port = "9002")
+            : queues_(std::move(queues)),
               host_(std::move(host)),
               port_(std::move(port)),
               running_(false),
               ticks_received_(0),
-              parse_errors_(0)
+              parse_errors_(0),
+              shard_ticks_(queues_.size(), 0)
         {
+            if (queues_.empty())
+                throw std::invalid_argument("[CLIENT] TickClient needs at least one queue");
         }
 
         ~TickClient() { stop(); }
@@ -116,8 +146,41 @@ namespace MarketStream
                 client_thread_.join();
         }
 
+        // ========================================================================
+        // attach_journal() — write-ahead every tick before it is queued
+        // ========================================================================
+        // Call before start(). The client thread becomes the journal's single
+        // producer and copies each tick into the mapped journal BEFORE the
+        // consumer can see it: a process crash loses no tick the pipeline saw.
+        // A power loss can still lose the journal's sync window (JournalSync).
+        // ========================================================================
+        void attach_journal(TickJournal *journal) { journal_ = journal; }
+
         size_t ticks_received() const { return ticks_received_.load(std::memory_order_relaxed); }
         size_t parse_errors() const { return parse_errors_.load(std::memory_order_relaxed); }
+        // Journaled but never queued: stop() arrived while the queue was full
+        size_t ticks_dropped() const { return ticks_dropped_.load(std::memory_order_relaxed); }
+
+        // Ticks routed to each queue — read after stop() (plain counters,
+        // written only by the client thread). Shows hash skew across shards.
+        const std::vector<size_t> &shard_ticks() const { return shard_ticks_; }
+
+        // ========================================================================
+        // shard_of() — which of `shards` queues a symbol belongs to
+        // ========================================================================
+        // SymbolKey::hash() mixes best into its HIGH bits, so take the top 32
+        // and scale them into [0, shards) with a multiply-shift (no division,
+        // works for any shard count, not just powers of 2).
+        // Consumers can call this to know which symbols they own.
+        // ========================================================================
+        [[nodiscard]]
+        static size_t shard_of(std::string_view symbol, size_t shards)
+        {
+            if (shards <= 1)
+                return 0;
+            const uint64_t top = SymbolKey::from(symbol).hash() >> 32;
+            return static_cast<size_t>((top * shards) >> 32);
+        }
 
     private:
         // ========================================================================
@@ -125,6 +188,9 @@ namespace MarketStream
         // ========================================================================
         void run()
         {
+            // Pin (and SCHED_FIFO, if planned) before the first read — see
+            // ThreadPlacement.hpp. No-op when ETL_CPU_PLAN is unset.
+            ThreadPlacement::apply(ThreadRole::Feed);
             try
             {
                 // ── STEP 1: Resolve and Connect ───────────────────────────────
@@ -208,16 +274,34 @@ namespace MarketStream
                         // Convert TickMessage → Trade (our internal domain model)
                         Trade trade = msg.to_trade();
 
+                        if (journal_)
+                            journal_->append(trade);
+
+                        // Route: one queue → always 0; sharded → by symbol hash
+                        const size_t shard = queues_.size() == 1 ? 0 : shard_of(trade.symbol, queues_.size());
+                        TradeQueue &queue = *queues_[shard];
+                        ++shard_ticks_[shard];
+
                         // Push to SPSCQueue. If full: yield and retry.
                         // WHY YIELD AND NOT SPIN?
                         // Queue full = consumer is slower than producer (backpressure).
                         // yield() = "I'm waiting, let the consumer run."
                         // The consumer pops, queue has space, we push on next attempt.
-                        while (!queue_.try_push(std::move(trade)) &&
+                        // Sharded: one slow consumer stalls the whole feed here —
+                        // skipping ahead would reorder or drop its symbols.
+                        bool queued;
+                        while (!(queued = queue.try_push(std::move(trade))) &&
                                running_.load(std::memory_order_relaxed))
                         {
                             std::this_thread::yield();
                         }
+                        if (!queued)
+                        {
+                            // Shutdown with the queue full: the tick is in the
+                            // journal only — the caller must keep the journal
+                            ticks_dropped_.fetch_add(1, std::memory_order_relaxed);
+                            continue;
+                        }
 
                         ticks_received_.fetch_add(1, std::memory_order_relaxed);
                     }
@@ -245,12 +329,15 @@ namespace MarketStream
                       << parse_errors_ << " parse errors.\n";
         }
 
-        TradeQueue &queue_;
+        std::vector<TradeQueue *> queues_;
         std::string host_;
         std::string port_;
         std::atomic<bool> running_;
         std::atomic<size_t> ticks_received_;
         std::atomic<size_t> parse_errors_;
+        std::atomic<size_t> ticks_dropped_{0};
+        std::vector<size_t> shard_ticks_;
+        TickJournal *journal_ = nullptr;
         std::thread client_thread_;
     };
 
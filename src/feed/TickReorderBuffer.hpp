@@ -0,0 +1,219 @@
+#pragma once
+
+// ============================================================================
+// TickReorderBuffer — Event-time ordering for the live tick stream
+// ============================================================================
+//
+// THE PROBLEM:
+// TickClient pushes ticks in ARRIVAL order. Everything downstream that builds
+// bars or indicators assumes TIMESTAMP order: an OrderFlowAccumulator that
+// has already closed the 10:00:01 bucket cannot take a 10:00:00 tick any more.
+// Real feeds deliver some ticks late — a retransmit, a slow gateway, two
+// exchange lines merged into one socket.
+//
+// THE FIX: hold each tick briefly, release in timestamp order.
+//
+//   per symbol:  max_seen  = largest timestamp received so far
+//                watermark = max_seen − allowed_lateness
+//   release every buffered tick with timestamp <= watermark, oldest first
+//
+// A tick arriving up to `allowed_lateness` behind the newest one is put back
+// in order. A tick older than what we ALREADY released is too late — it can't
+// be ordered any more — so it is counted and handed to the `late` callback
+// (drop it, log it, or send it to a correction path).
+//
+// WHY PER SYMBOL?
+// Ordering only matters within a symbol (bars and indicators are per symbol).
+// A burst on RELIANCE must not hold back TCS ticks that are already safe.
+//
+// WHY A BINARY HEAP (and not a pairing heap or a timing wheel)?
+//   • push/pop are O(log k), k = ticks buffered for ONE symbol — with a
+//     50ms lateness budget k is a few dozen, so log k ≈ 5 compares.
+//   • std::push_heap/pop_heap over a std::vector: one contiguous allocation,
+//     reused forever. A pairing heap allocates a node per tick; a timing wheel
+//     needs a fixed time resolution and wastes slots for sparse symbols.
+//   • Every tick waits — in order or not — until the watermark passes it,
+//     i.e. until a tick `allowed_lateness` newer arrives on its symbol (or
+//     advance_to() moves event time on). The heap holds ~one lateness budget
+//     of ticks per symbol; that is the latency price of ordering.
+//
+// BOUNDED MEMORY:
+// If one symbol accumulates `max_buffered_per_symbol` ticks (e.g. its clock
+// jumped far ahead), the oldest is force-released. Memory per symbol is
+// capped no matter what the feed does.
+//
+// Single-threaded: lives on the consumer thread, between SPSCQueue::try_pop()
+// and the aggregations.
+// ============================================================================
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm> // std::push_heap, std::pop_heap
+#include <cstdint>
+#include <utility>   // std::move
+#include "../model/Trade.hpp"
+#include "../model/SymbolKey.hpp"
+
+namespace MarketStream
+{
+
+    struct ReorderConfig
+    {
+        long long allowed_lateness_ns = 50'000'000; // 50ms behind the newest tick
+        size_t max_buffered_per_symbol = 1024;      // Force-release beyond this
+    };
+
+    struct ReorderStats
+    {
+        uint64_t received = 0;
+        uint64_t released = 0;
+        uint64_t reordered = 0;      // Arrived behind a newer tick, put back in order
+        uint64_t late = 0;           // Older than what was already released
+        uint64_t force_released = 0; // Released early because a buffer hit its cap
+        size_t max_depth = 0;        // Largest per-symbol buffer seen
+    };
+
+    class TickReorderBuffer
+    {
+    public:
+        explicit TickReorderBuffer(ReorderConfig config = {}) : config_(config) {}
+
+        // ========================================================================
+        // push() — accept one tick, release whatever is now safe
+        // ========================================================================
+        // emit(const Trade&) — called in timestamp order per symbol
+        // late(const Trade&) — called for ticks that can no longer be ordered
+        // ========================================================================
+        template <typename Emit, typename Late>
+        void push(Trade trade, Emit &&emit, Late &&late)
+        {
+            ++stats_.received;
+            Lane &lane = lanes_[SymbolKey::from(trade.symbol)];
+
+            if (lane.released_any && trade.timestamp < lane.last_released)
+            {
+                ++stats_.late;
+                late(trade);
+                return;
+            }
+            if (trade.timestamp < lane.max_seen)
+                ++stats_.reordered;
+            else
+                lane.max_seen = trade.timestamp;
+
+            lane.heap.push_back(Entry{trade.timestamp, seq_++, std::move(trade)});
+            std::push_heap(lane.heap.begin(), lane.heap.end(), later);
+            stats_.max_depth = std::max(stats_.max_depth, lane.heap.size());
+
+            // Bounded buffer: cap reached → release the oldest regardless
+            while (lane.heap.size() > config_.max_buffered_per_symbol)
+            {
+                ++stats_.force_released;
+                release_top(lane, emit);
+            }
+
+            const long long watermark = lane.max_seen - config_.allowed_lateness_ns;
+            while (!lane.heap.empty() && lane.heap.front().timestamp <= watermark)
+                release_top(lane, emit);
+        }
+
+        // Convenience overload: late ticks are counted and dropped.
+        template <typename Emit>
+        void push(Trade trade, Emit &&emit)
+        {
+            push(std::move(trade), std::forward<Emit>(emit), [](const Trade &) {});
+        }
+
+        // ========================================================================
+        // advance_to() — event-time heartbeat for quiet symbols
+        // ========================================================================
+        // A symbol that stops trading never advances its own watermark, so its
+        // last ticks would wait forever. Call this with a global event time
+        // (e.g. the newest timestamp across all symbols, or a feed heartbeat)
+        // to release every tick older than `event_time_ns − allowed_lateness`.
+        // The consumer calls it on a wall-clock timer — see websocket_demo.
+        // ========================================================================
+        template <typename Emit>
+        void advance_to(long long event_time_ns, Emit &&emit)
+        {
+            const long long watermark = event_time_ns - config_.allowed_lateness_ns;
+            for (auto &[key, lane] : lanes_)
+            {
+                while (!lane.heap.empty() && lane.heap.front().timestamp <= watermark)
+                    release_top(lane, emit);
+            }
+        }
+
+        // End of stream: release everything still buffered (ordered per symbol).
+        template <typename Emit>
+        void flush(Emit &&emit)
+        {
+            for (auto &[key, lane] : lanes_)
+            {
+                while (!lane.heap.empty())
+                    release_top(lane, emit);
+            }
+        }
+
+        [[nodiscard]]
+        size_t buffered() const
+        {
+            size_t n = 0;
+            for (const auto &[key, lane] : lanes_)
+                n += lane.heap.size();
+            return n;
+        }
+
+        [[nodiscard]]
+        const ReorderStats &stats() const { return stats_; }
+
+        [[nodiscard]]
+        const ReorderConfig &config() const { return config_; }
+
+    private:
+        struct Entry
+        {
+            long long timestamp;
+            uint64_t seq; // Arrival order — equal timestamps stay FIFO
+            Trade trade;
+        };
+
+        struct Lane
+        {
+            std::vector<Entry> heap; // Min-heap on (timestamp, seq)
+            long long max_seen = 0;
+            long long last_released = 0;
+            bool released_any = false;
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(const SymbolKey &k) const { return static_cast<size_t>(k.hash()); }
+        };
+
+        // std heap algorithms build a MAX-heap by the comparator; "a is later
+        // than b" turns that into a min-heap on (timestamp, seq).
+        static bool later(const Entry &a, const Entry &b)
+        {
+            return a.timestamp != b.timestamp ? a.timestamp > b.timestamp : a.seq > b.seq;
+        }
+
+        template <typename Emit>
+        void release_top(Lane &lane, Emit &emit)
+        {
+            std::pop_heap(lane.heap.begin(), lane.heap.end(), later);
+            Entry &e = lane.heap.back();
+            lane.last_released = e.timestamp;
+            lane.released_any = true;
+            ++stats_.released;
+            emit(static_cast<const Trade &>(e.trade));
+            lane.heap.pop_back();
+        }
+
+        ReorderConfig config_;
+        ReorderStats stats_;
+        uint64_t seq_ = 0;
+        std::unordered_map<SymbolKey, Lane, KeyHash> lanes_;
+    };
+
+} // namespace MarketStream
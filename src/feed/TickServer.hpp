@@ -49,6 +49,7 @@
 #include <unordered_map>
 
 #include "../feed/TickMessage.hpp"
+#include "../threading/ThreadPlacement.hpp"
 
 // Namespace aliases — Boost's names are long. These shorten them.
 // 'namespace X = Y' means: in this file, X and Y are interchangeable.
@@ -143,6 +144,7 @@ namespace MarketStream
         // ========================================================================
         void run(std::shared_ptr<std::promise<void>> ready_promise)
         {
+            ThreadPlacement::apply(ThreadRole::Server); // ETL_CPU_PLAN; no-op when unset
             try
             {
                 // ── STEP 1: Bind and listen ────────────────────────────────────
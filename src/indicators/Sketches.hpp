@@ -0,0 +1,635 @@
+#pragma once
+
+// ============================================================================
+// Sketches — Fixed-memory, mergeable summaries for monitoring
+// ============================================================================
+//
+// THE PROBLEM WITH EXACT ANSWERS
+// "p99 price of RELIANCE today" exactly = keep EVERY price, sort them.
+// "How many distinct order_ids?" exactly = a hash set of EVERY order_id.
+// "Top 10 symbols by volume" exactly = a counter for EVERY symbol.
+// Memory grows with the data, and two threads' partial answers can't simply
+// be added together (the p99 of two halves is NOT the p99 of the whole).
+//
+// A SKETCH answers the same question approximately, in FIXED memory,
+// and two sketches MERGE into the sketch of the combined data:
+//
+//   KllSketch     — quantiles (p50/p95/p99) within ~1% rank error, ~2-3 KB
+//   HyperLogLog   — distinct count within ~1.6% (p = 12), 4 KB
+//   SpaceSaving   — top-N heavy hitters with guaranteed error bounds
+//
+// MERGEABLE = we can build one sketch per thread / per shard / per file with
+// no locking, then merge at the end. The merged sketch has the SAME accuracy
+// guarantee as one built over all the data sequentially.
+//
+// MarketSketches bundles them per symbol and is what the pipeline uses:
+//   batch:  MarketSketches::build_parallel(trades, pool_threads)
+//   live:   sketches.update(trade) on the consumer thread
+//   report: sketches.snapshot() → plain structs for printing
+// ============================================================================
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <array>
+#include <algorithm> // std::sort, std::max, std::min
+#include <cmath>     // std::pow, std::log, std::ldexp
+#include <bit>       // std::countl_zero
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <future>
+#include <iostream>
+#include <iomanip>
+#include "../model/Trade.hpp"
+#include "../threading/ThreadPool.hpp"
+
+namespace MarketStream
+{
+
+    // ============================================================================
+    // KllSketch — streaming quantiles (Karnin, Lang, Liberty 2016)
+    // ============================================================================
+    // HOW IT WORKS:
+    // Items live in LEVELS. An item at level h stands for 2^h original items.
+    // Level 0 receives new values. When a level overflows its capacity, it is
+    // COMPACTED: sort it, keep every other item (random odd/even offset), and
+    // promote the survivors to level h+1 — where each now weighs twice as much.
+    //
+    // Capacities shrink geometrically going DOWN from the top level
+    // (k, 2k/3, 4k/9, ...) so most memory sits in the heavy top levels, where
+    // errors matter most. Total size is O(k) regardless of stream length.
+    //
+    // k = 200 → ~1.3% normalized rank error; memory ≈ 3k doubles.
+    // ============================================================================
+    class KllSketch
+    {
+    public:
+        explicit KllSketch(uint16_t k = 200, uint64_t seed = 0x9E3779B97F4A7C15ULL)
+            : k_(std::max<uint16_t>(k, 8)), rng_(seed | 1)
+        {
+            levels_.emplace_back();
+            recompute_capacities();
+        }
+
+        void update(double x)
+        {
+            if (n_ == 0)
+                min_ = max_ = x;
+            min_ = std::min(min_, x);
+            max_ = std::max(max_, x);
+            ++n_;
+            levels_[0].push_back(x);
+            ++retained_;
+            // "Lazy" KLL: compact only when the WHOLE sketch is full, and then
+            // only the lowest level that is over its own capacity.
+            if (retained_ >= total_capacity_)
+                compress();
+        }
+
+        // ========================================================================
+        // merge() — fold another sketch in (other is unchanged)
+        // ========================================================================
+        // Concatenate level by level, then compress until within capacity.
+        // ========================================================================
+        void merge(const KllSketch &other)
+        {
+            if (other.n_ == 0)
+                return;
+            if (n_ == 0)
+            {
+                min_ = other.min_;
+                max_ = other.max_;
+            }
+            min_ = std::min(min_, other.min_);
+            max_ = std::max(max_, other.max_);
+            n_ += other.n_;
+
+            if (other.levels_.size() > levels_.size())
+            {
+                levels_.resize(other.levels_.size());
+                recompute_capacities();
+            }
+            for (size_t h = 0; h < other.levels_.size(); ++h)
+                levels_[h].insert(levels_[h].end(), other.levels_[h].begin(), other.levels_[h].end());
+            retained_ += other.retained_;
+
+            while (retained_ >= total_capacity_)
+                compress();
+        }
+
+        // ========================================================================
+        // quantile() — value at normalized rank q (0 = min, 0.5 = median, 1 = max)
+        // ========================================================================
+        [[nodiscard]]
+        double quantile(double q) const
+        {
+            if (n_ == 0)
+                return 0.0;
+            if (q <= 0.0)
+                return min_;
+            if (q >= 1.0)
+                return max_;
+
+            // (value, weight) pairs, sorted by value → walk the cumulative weight
+            std::vector<std::pair<double, uint64_t>> weighted;
+            weighted.reserve(retained_);
+            for (size_t h = 0; h < levels_.size(); ++h)
+                for (double v : levels_[h])
+                    weighted.emplace_back(v, uint64_t{1} << h);
+            std::sort(weighted.begin(), weighted.end());
+
+            uint64_t total = 0;
+            for (const auto &w : weighted)
+                total += w.second;
+
+            const double target = q * static_cast<double>(total);
+            uint64_t cumulative = 0;
+            for (const auto &[value, weight] : weighted)
+            {
+                cumulative += weight;
+                if (static_cast<double>(cumulative) >= target)
+                    return value;
+            }
+            return max_;
+        }
+
+        [[nodiscard]]
+        uint64_t count() const { return n_; }
+        [[nodiscard]]
+        double min() const { return min_; }
+        [[nodiscard]]
+        double max() const { return max_; }
+
+        // Items actually stored (≈ memory / 8 bytes)
+        [[nodiscard]]
+        size_t retained() const { return retained_; }
+
+    private:
+        // Capacity of level h when there are H levels: k·(2/3)^(H−1−h), min 2.
+        // Cached — only changes when a level is added.
+        void recompute_capacities()
+        {
+            const size_t H = levels_.size();
+            capacities_.resize(H);
+            total_capacity_ = 0;
+            for (size_t h = 0; h < H; ++h)
+            {
+                const double cap = static_cast<double>(k_) * std::pow(2.0 / 3.0, static_cast<double>(H - 1 - h));
+                capacities_[h] = std::max<size_t>(2, static_cast<size_t>(cap));
+                total_capacity_ += capacities_[h];
+            }
+        }
+
+        // Compact the LOWEST level that is at/over capacity
+        void compress()
+        {
+            for (size_t h = 0; h < levels_.size(); ++h)
+            {
+                if (levels_[h].size() < capacities_[h])
+                    continue;
+
+                if (h + 1 == levels_.size())
+                {
+                    levels_.emplace_back();
+                    recompute_capacities();
+                }
+
+                auto &lvl = levels_[h];
+                std::sort(lvl.begin(), lvl.end());
+
+                // Odd count: hold back one item so the promoted pairs are exact
+                double held = 0.0;
+                const bool odd = (lvl.size() % 2) != 0;
+                if (odd)
+                {
+                    held = lvl.back();
+                    lvl.pop_back();
+                }
+
+                // Random offset: keep items 0,2,4… or 1,3,5… — unbiased in expectation
+                const size_t offset = next_bit();
+                auto &up = levels_[h + 1];
+                const size_t pairs = lvl.size() / 2;
+                for (size_t i = offset; i < lvl.size(); i += 2)
+                    up.push_back(lvl[i]);
+
+                lvl.clear();
+                if (odd)
+                    lvl.push_back(held);
+                retained_ -= pairs; // 2·pairs items became `pairs` items
+                return;
+            }
+        }
+
+        // xorshift64 — one random bit per compaction, deterministic per seed
+        size_t next_bit()
+        {
+            rng_ ^= rng_ << 13;
+            rng_ ^= rng_ >> 7;
+            rng_ ^= rng_ << 17;
+            return static_cast<size_t>(rng_ & 1);
+        }
+
+        uint16_t k_;
+        uint64_t rng_;
+        uint64_t n_ = 0;
+        size_t retained_ = 0;
+        size_t total_capacity_ = 0;
+        double min_ = 0.0;
+        double max_ = 0.0;
+        std::vector<std::vector<double>> levels_;
+        std::vector<size_t> capacities_;
+    };
+
+    // ============================================================================
+    // HyperLogLog — distinct count in 2^P bytes (Flajolet et al. 2007)
+    // ============================================================================
+    // Hash every value to 64 bits. The top P bits pick one of 2^P registers;
+    // the register keeps the MAX number of leading zeros (+1) seen in the
+    // remaining bits. Many distinct values → some hash with a long zero run.
+    // The harmonic mean of 2^register over all registers estimates the count.
+    //
+    // P = 12 → 4096 one-byte registers, standard error 1.04/√4096 ≈ 1.6%.
+    // Merge = register-wise max. Exact same result as one sketch over both inputs.
+    // ============================================================================
+    template <unsigned P = 12>
+    class HyperLogLog
+    {
+        static_assert(P >= 4 && P <= 18, "HyperLogLog precision must be in [4, 18]");
+
+    public:
+        static constexpr size_t M = size_t{1} << P;
+
+        // Add a raw 64-bit value (hashed here — order_ids are sequential)
+        void add(uint64_t value) { add_hash(mix(value)); }
+
+        void add_hash(uint64_t hash)
+        {
+            const size_t idx = static_cast<size_t>(hash >> (64 - P));
+            // Remaining 64−P bits, with a sentinel 1 so countl_zero is bounded
+            const uint64_t rest = (hash << P) | (uint64_t{1} << (P - 1));
+            const uint8_t rank = static_cast<uint8_t>(std::countl_zero(rest) + 1);
+            registers_[idx] = std::max(registers_[idx], rank);
+        }
+
+        void merge(const HyperLogLog &other)
+        {
+            for (size_t i = 0; i < M; ++i)
+                registers_[i] = std::max(registers_[i], other.registers_[i]);
+        }
+
+        [[nodiscard]]
+        double estimate() const
+        {
+            double sum = 0.0;
+            size_t zeros = 0;
+            for (uint8_t r : registers_)
+            {
+                sum += std::ldexp(1.0, -static_cast<int>(r)); // 2^-r
+                zeros += (r == 0);
+            }
+
+            const double m = static_cast<double>(M);
+            const double alpha = 0.7213 / (1.0 + 1.079 / m);
+            const double raw = alpha * m * m / sum;
+
+            // Small-range correction: with many empty registers, linear
+            // counting (m·ln(m/zeros)) is more accurate than the raw estimate.
+            if (raw <= 2.5 * m && zeros > 0)
+                return m * std::log(m / static_cast<double>(zeros));
+            return raw;
+        }
+
+    private:
+        static uint64_t mix(uint64_t x)
+        {
+            x ^= x >> 30;
+            x *= 0xBF58476D1CE4E5B9ULL;
+            x ^= x >> 27;
+            x *= 0x94D049BB133111EBULL;
+            x ^= x >> 31;
+            return x;
+        }
+
+        std::array<uint8_t, M> registers_{};
+    };
+
+    // ============================================================================
+    // SpaceSaving — top-N heavy hitters (Metwally, Agrawal, El Abbadi 2005)
+    // ============================================================================
+    // Keep at most `capacity` counters. A new key that does not fit REPLACES
+    // the smallest counter and inherits its count (recorded as `error`).
+    // Guarantees: every key with true weight > total/capacity is tracked, and
+    //   count − error ≤ true weight ≤ count.
+    //
+    // Weighted: update("RELIANCE", volume) ranks symbols by VOLUME, not trades.
+    // ============================================================================
+    struct HeavyHitter
+    {
+        std::string key;
+        uint64_t count; // upper bound on true weight
+        uint64_t error; // count − error = lower bound
+    };
+
+    class SpaceSaving
+    {
+    public:
+        explicit SpaceSaving(size_t capacity = 64) : capacity_(std::max<size_t>(capacity, 1)) {}
+
+        void update(const std::string &key, uint64_t weight = 1)
+        {
+            total_ += weight;
+            auto it = index_.find(key);
+            if (it != index_.end())
+            {
+                counters_[it->second].count += weight;
+                return;
+            }
+            if (counters_.size() < capacity_)
+            {
+                index_.emplace(key, counters_.size());
+                counters_.push_back({key, weight, 0});
+                return;
+            }
+            // Evict the minimum. O(capacity) scan — only on a miss with a full
+            // table; for symbol-level keys (tens of symbols) this never happens.
+            size_t min_i = 0;
+            for (size_t i = 1; i < counters_.size(); ++i)
+                if (counters_[i].count < counters_[min_i].count)
+                    min_i = i;
+            HeavyHitter &victim = counters_[min_i];
+            index_.erase(victim.key);
+            const uint64_t floor = victim.count;
+            victim = {key, floor + weight, floor};
+            index_.emplace(key, min_i);
+        }
+
+        // ========================================================================
+        // merge() — combined summary of both streams (Agarwal et al. 2012)
+        // ========================================================================
+        // A key missing from a FULL sketch may still have occurred there up to
+        // that sketch's minimum count — add it as both count and error.
+        // Then keep the `capacity` largest.
+        // ========================================================================
+        void merge(const SpaceSaving &other)
+        {
+            const uint64_t my_floor = counters_.size() < capacity_ ? 0 : min_count();
+            const uint64_t other_floor = other.counters_.size() < other.capacity_ ? 0 : other.min_count();
+
+            std::unordered_map<std::string, HeavyHitter> combined;
+            for (const auto &c : counters_)
+            {
+                auto o = other.index_.find(c.key);
+                if (o != other.index_.end())
+                {
+                    const auto &oc = other.counters_[o->second];
+                    combined[c.key] = {c.key, c.count + oc.count, c.error + oc.error};
+                }
+                else
+                {
+                    combined[c.key] = {c.key, c.count + other_floor, c.error + other_floor};
+                }
+            }
+            for (const auto &oc : other.counters_)
+            {
+                if (!index_.count(oc.key))
+                    combined[oc.key] = {oc.key, oc.count + my_floor, oc.error + my_floor};
+            }
+
+            std::vector<HeavyHitter> all;
+            all.reserve(combined.size());
+            for (auto &[key, hh] : combined)
+                all.push_back(std::move(hh));
+            std::sort(all.begin(), all.end(),
+                      [](const HeavyHitter &a, const HeavyHitter &b)
+                      { return a.count > b.count; });
+            if (all.size() > capacity_)
+                all.resize(capacity_);
+
+            counters_ = std::move(all);
+            index_.clear();
+            for (size_t i = 0; i < counters_.size(); ++i)
+                index_.emplace(counters_[i].key, i);
+            total_ += other.total_;
+        }
+
+        // Largest `n` counters, descending
+        [[nodiscard]]
+        std::vector<HeavyHitter> top(size_t n) const
+        {
+            std::vector<HeavyHitter> out = counters_;
+            std::sort(out.begin(), out.end(),
+                      [](const HeavyHitter &a, const HeavyHitter &b)
+                      { return a.count > b.count; });
+            if (out.size() > n)
+                out.resize(n);
+            return out;
+        }
+
+        [[nodiscard]]
+        uint64_t total() const { return total_; }
+
+    private:
+        [[nodiscard]]
+        uint64_t min_count() const
+        {
+            uint64_t m = std::numeric_limits<uint64_t>::max();
+            for (const auto &c : counters_)
+                m = std::min(m, c.count);
+            return counters_.empty() ? 0 : m;
+        }
+
+        size_t capacity_;
+        uint64_t total_ = 0;
+        std::vector<HeavyHitter> counters_;
+        std::unordered_map<std::string, size_t> index_;
+    };
+
+    // ============================================================================
+    // Snapshot structs — plain values for reports (no sketch internals)
+    // ============================================================================
+    struct SymbolSketchSnapshot
+    {
+        std::string symbol;
+        uint64_t trades;
+        double price_min, price_p50, price_p95, price_p99, price_max;
+        double volume_p50, volume_p95, volume_p99;
+        double distinct_orders; // HyperLogLog estimate
+    };
+
+    struct MarketSketchSnapshot
+    {
+        uint64_t trades = 0;
+        double distinct_orders = 0.0;
+        std::vector<SymbolSketchSnapshot> symbols; // sorted by symbol
+        std::vector<HeavyHitter> top_by_volume;    // descending
+    };
+
+    // ============================================================================
+    // MarketSketches — per-symbol quantiles + distinct orders + heavy hitters
+    // ============================================================================
+    // Single-writer: one instance per thread (batch shard) or per consumer
+    // (live feed). Combine instances with merge().
+    // ============================================================================
+    class MarketSketches
+    {
+    public:
+        explicit MarketSketches(size_t top_n_capacity = 64) : top_volume_(top_n_capacity) {}
+
+        void update(const Trade &t)
+        {
+            auto it = per_symbol_.find(t.symbol);
+            if (it == per_symbol_.end())
+                it = per_symbol_.try_emplace(t.symbol).first;
+
+            PerSymbol &s = it->second;
+            s.price.update(t.price);
+            s.volume.update(static_cast<double>(t.volume));
+            s.orders.add(t.order_id);
+
+            orders_.add(t.order_id);
+            top_volume_.update(t.symbol, t.volume);
+            ++trades_;
+        }
+
+        void merge(const MarketSketches &other)
+        {
+            for (const auto &[symbol, s] : other.per_symbol_)
+            {
+                auto [it, inserted] = per_symbol_.try_emplace(symbol, s);
+                if (!inserted)
+                {
+                    it->second.price.merge(s.price);
+                    it->second.volume.merge(s.volume);
+                    it->second.orders.merge(s.orders);
+                }
+            }
+            orders_.merge(other.orders_);
+            top_volume_.merge(other.top_volume_);
+            trades_ += other.trades_;
+        }
+
+        [[nodiscard]]
+        MarketSketchSnapshot snapshot(size_t top_n = 10) const
+        {
+            MarketSketchSnapshot snap;
+            snap.trades = trades_;
+            snap.distinct_orders = orders_.estimate();
+            snap.top_by_volume = top_volume_.top(top_n);
+
+            snap.symbols.reserve(per_symbol_.size());
+            for (const auto &[symbol, s] : per_symbol_)
+            {
+                snap.symbols.push_back({symbol, s.price.count(),
+                                        s.price.min(), s.price.quantile(0.50), s.price.quantile(0.95),
+                                        s.price.quantile(0.99), s.price.max(),
+                                        s.volume.quantile(0.50), s.volume.quantile(0.95), s.volume.quantile(0.99),
+                                        s.orders.estimate()});
+            }
+            std::sort(snap.symbols.begin(), snap.symbols.end(),
+                      [](const SymbolSketchSnapshot &a, const SymbolSketchSnapshot &b)
+                      { return a.symbol < b.symbol; });
+            return snap;
+        }
+
+        // ========================================================================
+        // build_parallel() — BATCH mode: shard trades across a ThreadPool
+        // ========================================================================
+        // Each task sketches one contiguous span into its OWN MarketSketches
+        // (no shared state, no locks), then the main thread merges the shards.
+        // ========================================================================
+        [[nodiscard]]
+        static MarketSketches build_parallel(const std::vector<Trade> &trades, size_t num_threads = 4)
+        {
+            num_threads = std::max<size_t>(1, std::min(num_threads, trades.size() / 10'000 + 1));
+
+            ThreadPool pool(num_threads);
+            std::vector<std::future<MarketSketches>> shards;
+            shards.reserve(num_threads);
+
+            const size_t chunk = trades.size() / num_threads;
+            const size_t remainder = trades.size() % num_threads;
+            size_t offset = 0;
+            for (size_t i = 0; i < num_threads; ++i)
+            {
+                const size_t len = chunk + (i < remainder ? 1 : 0);
+                std::span<const Trade> slice(trades.data() + offset, len);
+                offset += len;
+
+                shards.push_back(pool.submit(
+                    [slice]()
+                    {
+                        MarketSketches local;
+                        for (const auto &t : slice)
+                            local.update(t);
+                        return local;
+                    }));
+            }
+
+            MarketSketches merged;
+            for (auto &f : shards)
+                merged.merge(f.get());
+            return merged;
+        }
+
+        static void print_snapshot(const MarketSketchSnapshot &snap)
+        {
+            std::cout << "\n";
+            std::cout << "╔════════════╦════════════╦════════════╦════════════╦══════════╦══════════╦════════════╗\n";
+            std::cout << "║ Symbol     ║ Price p50  ║ Price p95  ║ Price p99  ║ Qty p50  ║ Qty p99  ║ ~Orders    ║\n";
+            std::cout << "╠════════════╬════════════╬════════════╬════════════╬══════════╬══════════╬════════════╣\n";
+            for (const auto &s : snap.symbols)
+            {
+                std::cout << "║ "
+                          << std::left << std::setw(10) << s.symbol
+                          << " ║ "
+                          << std::right << std::fixed << std::setprecision(2)
+                          << std::setw(10) << s.price_p50
+                          << " ║ "
+                          << std::setw(10) << s.price_p95
+                          << " ║ "
+                          << std::setw(10) << s.price_p99
+                          << " ║ "
+                          << std::setprecision(0)
+                          << std::setw(8) << s.volume_p50
+                          << " ║ "
+                          << std::setw(8) << s.volume_p99
+                          << " ║ "
+                          << std::setw(10) << s.distinct_orders
+                          << " ║\n";
+            }
+            std::cout << "╚════════════╩════════════╩════════════╩════════════╩══════════╩══════════╩════════════╝\n";
+
+            std::cout << "[SKETCH] Trades seen        : " << snap.trades << "\n";
+            std::cout << "[SKETCH] Distinct orders    : ~" << std::fixed << std::setprecision(0)
+                      << snap.distinct_orders << " (HyperLogLog, ±1.6%)\n";
+            std::cout << "[SKETCH] Top symbols by volume:\n";
+            for (size_t i = 0; i < snap.top_by_volume.size(); ++i)
+            {
+                const auto &h = snap.top_by_volume[i];
+                std::cout << "[SKETCH]   " << std::setw(2) << (i + 1) << ". "
+                          << std::left << std::setw(10) << h.key << std::right
+                          << std::setw(14) << h.count;
+                if (h.error > 0)
+                    std::cout << "  (±" << h.error << ")";
+                std::cout << "\n";
+            }
+            std::cout << "\n";
+        }
+
+    private:
+        struct PerSymbol
+        {
+            KllSketch price = KllSketch();
+            KllSketch volume = KllSketch(200, 0xD1B54A32D192ED03ULL);
+            HyperLogLog<12> orders;
+        };
+
+        uint64_t trades_ = 0;
+        std::unordered_map<std::string, PerSymbol> per_symbol_;
+        HyperLogLog<12> orders_;
+        SpaceSaving top_volume_;
+    };
+
+} // namespace MarketStream
@@ -29,13 +29,25 @@
 //   WHY: Institutional traders benchmark their execution against VWAP.
 //        "Did we buy below VWAP?" = good execution.
 //        "Did we buy above VWAP?" = we paid too much.
+//
+// TWO OUTPUT SHAPES:
+//   compute_all()     — ONE IndicatorResult per symbol (the latest value).
+//                       Feeds the technical_indicators table.
+//   compute_rolling() — ONE value per TRADE, aligned with the input vector.
+//                       Feeds extra Parquet columns, so research jobs read
+//                       sma_5/rsi_5/vwap next to every trade instead of
+//                       recomputing rolling windows in pandas.
 // ============================================================================
 
 #include <vector>
 #include <string>
 #include <unordered_map> // Hash map: O(1) average lookup by symbol
+#include <unordered_set> // results_from_state(): symbols traded in the batch
+#include <string_view>
 #include <numeric>       // std::accumulate — sum a range of numbers
 #include <stdexcept>     // std::invalid_argument
+#include <algorithm>     // std::min
+#include <limits>        // std::numeric_limits — "nothing applied yet" watermark
 #include <iostream>
 #include <iomanip>
 #include "../model/Trade.hpp"
@@ -55,6 +67,206 @@ namespace MarketStream
         int period;         // How many trades were used in calculation
     };
 
+    // ============================================================================
+    // RollingIndicatorColumns — one indicator value per trade
+    // ============================================================================
+    // Column layout (struct of vectors), aligned with the trades vector passed
+    // to compute_rolling(): sma[i] belongs to trades[i].
+    // Each value uses ONLY that symbol's trades up to and including row i —
+    // no look-ahead, so the columns are safe to use as ML features.
+    // ============================================================================
+    struct RollingIndicatorColumns
+    {
+        std::vector<double> sma;
+        std::vector<double> rsi;
+        std::vector<double> vwap;
+        int period = 0;
+        size_t skipped = 0; // rows at or before the warm-start high-watermark
+
+        [[nodiscard]]
+        size_t size() const { return sma.size(); }
+    };
+
+    // ============================================================================
+    // RollingIndicatorState — O(1)-per-trade sliding window for ONE symbol
+    // ============================================================================
+    // compute_sma() re-sums the last N prices: O(N) per call. Calling it for
+    // every trade would be O(n·N). Instead we keep the window in a ring buffer
+    // and maintain running sums:
+    //
+    //   new price arrives → sum += new − (price falling out of the window)
+    //
+    // Same trick for RSI: ring of the last N changes, running gain/loss sums.
+    // VWAP is cumulative, so it only needs Σ(price·volume) and Σ(volume) —
+    // cumulative over ONE session (UTC day): the sums restart with the first
+    // trade of a new day, so a warm start never turns it into all-history VWAP.
+    //
+    // HIGH-WATERMARK:
+    // The newest (timestamp, trade_id) ever applied is kept with the state.
+    // A re-sent or overlapping file would otherwise feed the same trades into
+    // the windows a second time; compute_rolling() skips them instead.
+    //
+    // WHY RESUM ON EVERY WRAP?
+    // "sum += new − old" accumulates rounding error: after a million updates
+    // the running sum drifts away from the true window sum. Every time the
+    // ring wraps we recompute the sums from the ring itself — O(N) work every
+    // N updates, still O(1) amortized, and the error never builds up.
+    //
+    // Edge cases match compute_all() on the same prefix of trades:
+    //   fewer than N prices  → SMA over what we have
+    //   no changes yet       → RSI 50 (neutral); period <= 1 → RSI 50
+    //   no losses in window  → RSI 100
+    // ============================================================================
+    class RollingIndicatorState
+    {
+    public:
+        // VWAP session length: one UTC day (the same days as trades_daily)
+        static constexpr long long SESSION_NS = 86'400'000'000'000LL;
+
+        explicit RollingIndicatorState(int period = 5)
+            : period_(period > 0 ? static_cast<size_t>(period) : 1),
+              prices_(period_, 0.0),
+              gains_(period_, 0.0),
+              losses_(period_, 0.0)
+        {
+        }
+
+        // Feed one trade, get this row's indicator values back.
+        void update(const Trade &t, double &sma, double &rsi, double &vwap)
+        {
+            const double price = t.price;
+            const double volume = static_cast<double>(t.volume);
+
+            // ── Session boundary: VWAP restarts each UTC day ─────────────────
+            long long day = t.timestamp / SESSION_NS;
+            if (t.timestamp % SESSION_NS < 0)
+                --day; // floor, so pre-1970 timestamps stay correct
+            if (day != session_day_)
+            {
+                session_day_ = day;
+                cum_pv_ = 0.0;
+                cum_volume_ = 0.0;
+            }
+
+            // ── High-watermark ───────────────────────────────────────────────
+            if (t.timestamp > last_timestamp_ ||
+                (t.timestamp == last_timestamp_ && t.trade_id > last_trade_id_))
+            {
+                last_timestamp_ = t.timestamp;
+                last_trade_id_ = t.trade_id;
+            }
+
+            // ── SMA window ───────────────────────────────────────────────────
+            const size_t slot = count_ % period_;
+            price_sum_ += price - prices_[slot]; // prices_[slot] is 0.0 until the ring fills
+            prices_[slot] = price;
+
+            // ── RSI window (changes, not prices) ─────────────────────────────
+            if (count_ > 0)
+            {
+                const double change = price - last_price_;
+                const size_t cslot = changes_ % period_;
+                const double gain = change > 0.0 ? change : 0.0;
+                const double loss = change > 0.0 ? 0.0 : -change;
+                gain_sum_ += gain - gains_[cslot];
+                loss_sum_ += loss - losses_[cslot];
+                gains_[cslot] = gain;
+                losses_[cslot] = loss;
+                ++changes_;
+                if (changes_ % period_ == 0)
+                    resum_changes();
+            }
+            last_price_ = price;
+            ++count_;
+            if (count_ % period_ == 0)
+                resum_prices();
+
+            // ── VWAP (cumulative within the session) ─────────────────────────
+            cum_pv_ += price * volume;
+            cum_volume_ += volume;
+
+            latest(sma, rsi, vwap);
+        }
+
+        // Indicator values after the most recent update (no new trade).
+        // Used to report end-of-run values from a warm-started state.
+        void latest(double &sma, double &rsi, double &vwap) const
+        {
+            const size_t window = std::min(count_, period_);
+            sma = window > 0 ? price_sum_ / static_cast<double>(window) : 0.0;
+
+            const size_t changes_in_window = std::min(changes_, period_);
+            if (changes_in_window == 0 || period_ <= 1)
+                rsi = 50.0;
+            else if (loss_sum_ <= 0.0)
+                rsi = 100.0;
+            else
+                rsi = 100.0 - (100.0 / (1.0 + gain_sum_ / loss_sum_));
+
+            vwap = cum_volume_ > 0.0 ? cum_pv_ / cum_volume_ : 0.0;
+        }
+
+        [[nodiscard]]
+        int period() const { return static_cast<int>(period_); }
+
+        [[nodiscard]]
+        size_t count() const { return count_; }
+
+        // Freeze the current high-watermark as the skip boundary for this run.
+        // compute_rolling() calls it once per warm-started symbol.
+        void begin_run()
+        {
+            resume_timestamp_ = last_timestamp_;
+            resume_trade_id_ = last_trade_id_;
+        }
+
+        // True when a previous run already applied this trade (at or before
+        // the watermark captured by begin_run()).
+        [[nodiscard]]
+        bool already_applied(const Trade &t) const
+        {
+            return t.timestamp < resume_timestamp_ ||
+                   (t.timestamp == resume_timestamp_ && t.trade_id <= resume_trade_id_);
+        }
+
+    private:
+        // Serializes the private window state (IndicatorCheckpoint.hpp)
+        friend class IndicatorCheckpoint;
+
+        void resum_prices()
+        {
+            price_sum_ = std::accumulate(prices_.begin(), prices_.end(), 0.0);
+        }
+
+        void resum_changes()
+        {
+            gain_sum_ = std::accumulate(gains_.begin(), gains_.end(), 0.0);
+            loss_sum_ = std::accumulate(losses_.begin(), losses_.end(), 0.0);
+        }
+
+        size_t period_;
+        std::vector<double> prices_; // Ring: last N prices
+        std::vector<double> gains_;  // Ring: last N positive changes
+        std::vector<double> losses_; // Ring: last N |negative changes|
+        size_t count_ = 0;           // Prices seen
+        size_t changes_ = 0;         // Changes seen (= count_ − 1 once started)
+        double last_price_ = 0.0;
+        double price_sum_ = 0.0;
+        double gain_sum_ = 0.0;
+        double loss_sum_ = 0.0;
+        double cum_pv_ = 0.0;
+        double cum_volume_ = 0.0;
+        long long session_day_ = std::numeric_limits<long long>::min(); // UTC day of cum_*
+        long long last_timestamp_ = std::numeric_limits<long long>::min();
+        uint64_t last_trade_id_ = 0;
+        long long resume_timestamp_ = std::numeric_limits<long long>::min(); // not persisted
+        uint64_t resume_trade_id_ = 0;
+    };
+
+    // Per-symbol streaming state. Passed to compute_rolling() to warm-start
+    // from a previous run and saved back by IndicatorCheckpoint.
+    using RollingStateMap = std::unordered_map<std::string, RollingIndicatorState>;
+
     // ============================================================================
     // TechnicalIndicators — Computes indicators from a vector of Trade objects
     // ============================================================================
@@ -137,6 +349,111 @@ namespace MarketStream
             return results;
         }
 
+        // ========================================================================
+        // compute_rolling()
+        // ========================================================================
+        // One SMA/RSI/VWAP value per trade, aligned with the input vector.
+        //
+        // Walks the trades ONCE in their original order. Each trade looks up its
+        // symbol's RollingIndicatorState (one hash lookup — the same cost as the
+        // grouping step of compute_all()) and does O(1) work.
+        // Total: O(n), independent of the period.
+        //
+        // Trades are assumed to be in time order per symbol (as the CSV and the
+        // live feed deliver them). Rows of different symbols may interleave.
+        //
+        // WARM START:
+        // Pass `state` (e.g. loaded by IndicatorCheckpoint::load) and each
+        // symbol continues from yesterday's window instead of from nothing —
+        // the first SMA/RSI of the day are correct without re-reading history.
+        // On return, `state` holds the end-of-run state, ready to be saved.
+        // Entries whose period differs from `period` are restarted cold.
+        //
+        // Rows at or before a symbol's checkpointed high-watermark were applied
+        // by an earlier run (a re-sent or overlapping file): they are NOT fed
+        // again, get the symbol's current values, and are counted in
+        // cols.skipped. The boundary is fixed at the start of the call, so
+        // out-of-order rows within this batch are never skipped.
+        // ========================================================================
+        [[nodiscard]]
+        static RollingIndicatorColumns compute_rolling(
+            const std::vector<Trade> &trades,
+            int period = 5,
+            RollingStateMap *state = nullptr)
+        {
+            if (period <= 0)
+                throw std::invalid_argument("[INDICATORS] Period must be > 0, got " + std::to_string(period));
+
+            RollingIndicatorColumns cols;
+            cols.period = period;
+            cols.sma.resize(trades.size());
+            cols.rsi.resize(trades.size());
+            cols.vwap.resize(trades.size());
+
+            RollingStateMap local_state;
+            RollingStateMap &state_by_symbol = state ? *state : local_state;
+            for (auto &[symbol, st] : state_by_symbol)
+            {
+                if (st.period() != period)
+                    st = RollingIndicatorState(period);
+                st.begin_run();
+            }
+
+            for (size_t i = 0; i < trades.size(); ++i)
+            {
+                const Trade &t = trades[i];
+                auto it = state_by_symbol.find(t.symbol);
+                if (it == state_by_symbol.end())
+                    it = state_by_symbol.emplace(t.symbol, RollingIndicatorState(period)).first;
+
+                if (it->second.already_applied(t))
+                {
+                    it->second.latest(cols.sma[i], cols.rsi[i], cols.vwap[i]);
+                    ++cols.skipped;
+                    continue;
+                }
+                it->second.update(t, cols.sma[i], cols.rsi[i], cols.vwap[i]);
+            }
+
+            return cols;
+        }
+
+        // ========================================================================
+        // results_from_state() — end-of-run IndicatorResult per symbol
+        // ========================================================================
+        // SMA/RSI as compute_all() would return them over the symbol's FULL
+        // history (every day since the checkpoint was started); VWAP over the
+        // symbol's latest session (UTC day). O(symbols) cost.
+        //
+        // batch: when given, only symbols that trade in it are returned. The
+        // checkpoint holds every symbol EVER seen; one that did not trade
+        // today would otherwise be saved with yesterday's values under
+        // today's computed_at.
+        // ========================================================================
+        [[nodiscard]]
+        static std::vector<IndicatorResult> results_from_state(const RollingStateMap &state,
+                                                               const std::vector<Trade> *batch = nullptr)
+        {
+            std::unordered_set<std::string_view> traded;
+            if (batch)
+                for (const auto &t : *batch)
+                    traded.insert(t.symbol);
+
+            std::vector<IndicatorResult> results;
+            results.reserve(batch ? traded.size() : state.size());
+            for (const auto &[symbol, st] : state)
+            {
+                if (st.count() == 0 || (batch && !traded.contains(symbol)))
+                    continue;
+                IndicatorResult result;
+                result.symbol = symbol;
+                result.period = static_cast<int>(std::min<size_t>(st.count(), static_cast<size_t>(st.period())));
+                st.latest(result.sma, result.rsi, result.vwap);
+                results.push_back(result);
+            }
+            return results;
+        }
+
         // ========================================================================
         // print_results() — Formatted console output
         // ========================================================================
@@ -7,7 +7,15 @@
 #include "validator/TradeValidator.hpp"
 #include "benchmark/Benchmarker.hpp"
 #include "indicators/TechnicalIndicators.hpp"
+#include "indicators/IndicatorEngine.hpp"
+#include "indicators/OrderFlow.hpp"
+#include "indicators/OrderAggregator.hpp"
+#include "indicators/Sketches.hpp"
+#include "indicators/CorrelationEngine.hpp"
+#include "indicators/IndicatorCheckpoint.hpp"
 #include "threading/ParallelLoader.hpp"
+#include "threading/ParallelRadixSort.hpp"
+#include "threading/PartitionedLoader.hpp"
 #include "output/ParquetWriter.hpp"
 
 int main()
@@ -20,6 +28,11 @@ int main()
 
     std::filesystem::path csv_file = "large_data.csv";
 
+    // Per-symbol indicator state carried from the previous run (see
+    // IndicatorCheckpoint.hpp). Override with ETL_INDICATOR_STATE=<path>.
+    const char *env_state = std::getenv("ETL_INDICATOR_STATE");
+    std::filesystem::path indicator_state_file = env_state ? env_state : "indicator_state.bin";
+
     // -------------------------------------------------------------------------
     // IMPROVEMENT 1: Read DB connection string from environment variable.
     //
@@ -62,6 +75,48 @@ int main()
     }
     std::string db_conn = env_conn;
 
+    // ETL_PARTITIONED=1 → load into the day-partitioned trades_daily table
+    // (PartitionedLoader) instead of the single trades table.
+    const char* env_partitioned = std::getenv("ETL_PARTITIONED");
+    const bool partitioned = env_partitioned && std::string(env_partitioned) == "1";
+
+    // ETL_LOAD_MODE = replace (default) | append | append-rebuild | auto | freeze
+    // replace: nightly full reload. append/auto: intraday deltas that keep
+    // the rows already in the table. freeze: nightly reload written frozen
+    // (no post-load VACUUM) — see LoadMode in DatabaseLoader.hpp.
+    // With ETL_PARTITIONED=1, replace/freeze replace the DAYS the file covers;
+    // the other modes merge into them — see PartitionedLoader.hpp.
+    MarketStream::LoadMode load_mode = MarketStream::LoadMode::Replace;
+    if (const char* env_mode = std::getenv("ETL_LOAD_MODE"))
+    {
+        try
+        {
+            load_mode = MarketStream::DatabaseLoader::parse_load_mode(env_mode);
+        }
+        catch (const std::invalid_argument& e)
+        {
+            std::cerr << "[ERROR] ETL_LOAD_MODE: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    // ETL_COPY_ENGINE = stream_to (default) | async
+    // async overlaps row encoding with the socket send on every COPY stream;
+    // the load summary prints per-stream MB/s for either engine.
+    MarketStream::CopyEngine copy_engine = MarketStream::CopyEngine::StreamTo;
+    if (const char* env_engine = std::getenv("ETL_COPY_ENGINE"))
+    {
+        try
+        {
+            copy_engine = MarketStream::DatabaseLoader::parse_copy_engine(env_engine);
+        }
+        catch (const std::invalid_argument& e)
+        {
+            std::cerr << "[ERROR] ETL_COPY_ENGINE: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
     std::vector<MarketStream::BenchmarkResult> bench_results;
 
     try
@@ -88,6 +143,14 @@ int main()
             std::cerr << "[CRITICAL] Zero valid trades. Aborting.\n";
             return 1;
         }
+
+        // Cluster by (symbol, timestamp, trade_id): per-symbol scans below walk
+        // contiguous memory, and COPY writes the table in index order, so the
+        // (symbol, timestamp) index rebuild in finalize reads presorted data.
+        {
+            MarketStream::Benchmarker bm("Sort", valid_trades.size(), bench_results);
+            MarketStream::ParallelRadixSort::sort_trades(valid_trades, 4);
+        }
         std::cout << "\n";
 
         // STAGE 3: COMPUTE INDICATORS
@@ -99,6 +162,77 @@ int main()
         }
         MarketStream::TechnicalIndicators::print_results(indicators);
 
+        // Multi-period view (5/14/50/200, EMA/Bollinger/MACD/ATR) for strategies.
+        // One grouping pass over all periods — see IndicatorEngine.hpp.
+        MarketStream::IndicatorEngineOutput engine_output;
+        {
+            MarketStream::Benchmarker bm("Indicator Engine", valid_trades.size(), bench_results);
+            engine_output = MarketStream::IndicatorEngine::compute(valid_trades);
+        }
+        MarketStream::IndicatorEngine::print_latest(engine_output.latest);
+
+        // Per-trade rolling SMA/RSI/VWAP — written as Parquet feature columns in Stage 6.
+        // Warm-started from yesterday's checkpoint, so the first trades of the
+        // day see full windows. With a checkpoint, the summary indicators come
+        // from the carried state too (compute_all only sees today's trades).
+        auto indicator_state = MarketStream::IndicatorCheckpoint::load(indicator_state_file, 5);
+        const bool warm_start = !indicator_state.empty();
+        MarketStream::RollingIndicatorColumns rolling_indicators;
+        {
+            MarketStream::Benchmarker bm("Rolling Indicators", valid_trades.size(), bench_results);
+            rolling_indicators = MarketStream::TechnicalIndicators::compute_rolling(valid_trades, 5, &indicator_state);
+        }
+        if (rolling_indicators.skipped > 0)
+            std::cout << "[CHECKPOINT] Skipped " << rolling_indicators.skipped
+                      << " trades already applied by a previous run (high-watermark).\n";
+        if (warm_start)
+        {
+            // Symbols in today's batch only — the state also holds every
+            // symbol that traded on an earlier day
+            indicators = MarketStream::TechnicalIndicators::results_from_state(indicator_state, &valid_trades);
+            std::cout << "[CHECKPOINT] Summary indicators continue from the previous run.\n";
+        }
+
+        // Buy/sell and pro/retail aggregates per symbol per 1-minute bucket.
+        std::vector<MarketStream::OrderFlowBucket> order_flow;
+        {
+            MarketStream::Benchmarker bm("Order Flow", valid_trades.size(), bench_results);
+            order_flow = MarketStream::OrderFlowAnalyzer::compute(valid_trades);
+        }
+        MarketStream::OrderFlowAnalyzer::print_summary(order_flow);
+
+        // Per-order fills for TCA (replaces GROUP BY order_id on the loaded table).
+        // Capacity hint = trade count: an order never has fewer than one fill.
+        std::vector<MarketStream::OrderFill> order_fills;
+        {
+            MarketStream::Benchmarker bm("Order Fills", valid_trades.size(), bench_results);
+            MarketStream::OrderAggregator aggregator(valid_trades.size());
+            aggregator.aggregate(valid_trades);
+            order_fills = aggregator.results();
+        }
+        std::cout << "[ORDERS] " << order_fills.size() << " distinct orders aggregated.\n\n";
+
+        // Monitoring sketches: per-symbol price/volume percentiles, distinct
+        // orders, top symbols by volume. Built per shard, merged (Sketches.hpp).
+        MarketStream::MarketSketches sketches;
+        {
+            MarketStream::Benchmarker bm("Sketches", valid_trades.size(), bench_results);
+            sketches = MarketStream::MarketSketches::build_parallel(valid_trades, 4);
+        }
+        MarketStream::MarketSketches::print_snapshot(sketches.snapshot());
+
+        // Cross-symbol return correlation on a common 1-second grid (CorrelationEngine.hpp).
+        {
+            MarketStream::Benchmarker bm("Correlation", valid_trades.size(), bench_results);
+            auto panel = MarketStream::ReturnResampler::resample(valid_trades);
+            if (panel.symbols.size() > 1)
+            {
+                MarketStream::CorrelationEngine correlation(panel.symbols.size(), 0, 4);
+                correlation.add_bars(panel);
+                MarketStream::CorrelationEngine::print_top_pairs(correlation.correlation(), panel.symbols, 5);
+            }
+        }
+
         // STAGE 4: INIT SCHEMA
         std::cout << "[STAGE 4] INIT SCHEMA\n";
         {
@@ -110,10 +244,30 @@ int main()
         // STAGE 5: PARALLEL DB LOAD (4 threads)
         // REMINDER: TRUNCATE TABLE trades; TRUNCATE TABLE technical_indicators;
         std::cout << "[STAGE 5] PARALLEL LOAD (4 threads)\n";
+        if (partitioned)
+        {
+            {
+                MarketStream::Benchmarker bm("Partitioned Load", valid_trades.size(), bench_results);
+                MarketStream::PartitionedLoader::run(db_conn, valid_trades, bench_results, 4,
+                                                     load_mode, copy_engine);
+            }
+            MarketStream::DatabaseLoader side_loader(db_conn);
+            side_loader.save_indicators(indicators);
+            side_loader.save_order_flow(order_flow);
+        }
+        else
         {
             MarketStream::Benchmarker bm("Parallel Load", valid_trades.size(), bench_results);
             MarketStream::ParallelLoader::run(
-                db_conn, valid_trades, indicators, bench_results, 4);
+                db_conn, valid_trades, indicators, order_flow, bench_results, 4, load_mode, copy_engine);
+        }
+        {
+            MarketStream::Benchmarker bm("Order Fills Save", order_fills.size(), bench_results);
+            MarketStream::DatabaseLoader fills_loader(db_conn);
+            // Append modes load a delta: add its fills, keep earlier orders'
+            const bool merge_fills = load_mode != MarketStream::LoadMode::Replace &&
+                                     load_mode != MarketStream::LoadMode::Freeze;
+            fills_loader.save_order_fills(order_fills, merge_fills);
         }
         std::cout << "\n";
 
@@ -125,10 +279,16 @@ int main()
         {
             auto parquet_path = MarketStream::ParquetWriter::make_output_path(".");
             MarketStream::Benchmarker bm("Parquet Write", valid_trades.size(), bench_results);
-            MarketStream::ParquetWriter::write(valid_trades, parquet_path);
+            MarketStream::ParquetWriter::write(valid_trades, rolling_indicators, parquet_path);
         }
         std::cout << "\n";
 
+        // Checkpoint LAST: a run that fails earlier leaves yesterday's state in
+        // place. A re-run or overlapping file after a SUCCESSFUL run is caught
+        // by the per-symbol high-watermark saved with the state.
+        MarketStream::IndicatorCheckpoint::save(indicator_state, indicator_state_file);
+        std::cout << "\n";
+
         // PERFORMANCE REPORT
         MarketStream::print_benchmark_report(bench_results);
 
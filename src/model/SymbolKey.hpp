@@ -0,0 +1,92 @@
+#pragma once
+
+// ============================================================================
+// SymbolKey — Fixed-size, allocation-free symbol identity for hot paths
+// ============================================================================
+//
+// WHY NOT JUST USE std::string AS THE KEY?
+// Trade::symbol is a std::string. Hashing it with std::hash walks every byte,
+// and storing it in an unordered_map allocates a node per symbol plus a heap
+// buffer for any symbol longer than the small-string buffer.
+// That's fine for batch grouping. It is NOT fine on the live consumer thread,
+// where every tick must be handled in a bounded number of nanoseconds.
+//
+// SymbolKey packs up to 16 characters into two uint64_t words:
+//   "RELIANCE" → words[0] = 'R','E','L','I','A','N','C','E'
+//                words[1] = 0 (zero padding)
+//   Comparison = 2 integer compares.   Hash = 2 multiplies.
+//   No loops over characters, no heap, trivially copyable.
+//
+// Symbols are validated as 1–10 uppercase letters (TradeValidator), so 16 bytes
+// always holds the full symbol. Longer input is truncated — two symbols that
+// share their first 16 characters would collide, which cannot happen for
+// validated tickers.
+// ============================================================================
+
+#include <cstdint>
+#include <cstring>     // std::memcpy — the defined-behavior way to pack bytes
+#include <string_view>
+#include <algorithm>   // std::min
+
+namespace MarketStream
+{
+
+    struct SymbolKey
+    {
+        static constexpr size_t MAX_LEN = 16;
+
+        uint64_t words[2]{0, 0};
+
+        // Build a key from any string-like symbol. Zero allocation.
+        [[nodiscard]]
+        static SymbolKey from(std::string_view symbol)
+        {
+            SymbolKey key;
+            // memcpy into the words array: compilers lower this to 1-2 moves.
+            // Bytes past symbol.size() stay zero — that is the padding.
+            std::memcpy(key.words, symbol.data(), std::min(symbol.size(), MAX_LEN));
+            return key;
+        }
+
+        // ====================================================================
+        // hash() — 64-bit mix of both words
+        // ====================================================================
+        // Multiply-xorshift (the finalizer from MurmurHash3 / splitmix64).
+        // WHY NOT std::hash<std::string_view>?
+        // It loops over bytes. We already have the bytes packed into integers,
+        // so two multiplies give an equally well-distributed hash.
+        // High bits are the best mixed — callers that need a bucket index
+        // should use the TOP bits (hash >> shift), not hash & mask.
+        // ====================================================================
+        [[nodiscard]]
+        uint64_t hash() const
+        {
+            uint64_t h = words[0] * 0x9E3779B97F4A7C15ULL;
+            h ^= words[1] + 0xBF58476D1CE4E5B9ULL + (h << 6) + (h >> 2);
+            h ^= h >> 31;
+            h *= 0x94D049BB133111EBULL;
+            h ^= h >> 29;
+            return h;
+        }
+
+        [[nodiscard]]
+        bool empty() const { return words[0] == 0 && words[1] == 0; }
+
+        // Back to text (for reports / DB writes — not for the hot path)
+        [[nodiscard]]
+        std::string_view view() const
+        {
+            const char *p = reinterpret_cast<const char *>(words);
+            size_t len = 0;
+            while (len < MAX_LEN && p[len] != '\0')
+                ++len;
+            return {p, len};
+        }
+
+        bool operator==(const SymbolKey &other) const
+        {
+            return words[0] == other.words[0] && words[1] == other.words[1];
+        }
+    };
+
+} // namespace MarketStream
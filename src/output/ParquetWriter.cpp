@@ -89,6 +89,37 @@ namespace MarketStream
     long long ParquetWriter::write(
         const std::vector<Trade> &trades,
         const std::filesystem::path &output_path)
+    {
+        return write_impl(trades, nullptr, output_path);
+    }
+
+    long long ParquetWriter::write(
+        const std::vector<Trade> &trades,
+        const RollingIndicatorColumns &indicators,
+        const std::filesystem::path &output_path)
+    {
+        // Misaligned columns would silently attach RELIANCE's SMA to a TCS row.
+        // Fail loudly instead.
+        if (indicators.size() != trades.size() ||
+            indicators.rsi.size() != trades.size() ||
+            indicators.vwap.size() != trades.size())
+        {
+            throw std::invalid_argument(
+                "[PARQUET ERROR] Indicator columns (" + std::to_string(indicators.size()) +
+                " rows) do not match trades (" + std::to_string(trades.size()) + " rows)");
+        }
+        return write_impl(trades, &indicators, output_path);
+    }
+
+    // =========================================================================
+    // write_impl()
+    // =========================================================================
+    // Trade columns always; indicator feature columns when indicators != nullptr.
+    // =========================================================================
+    long long ParquetWriter::write_impl(
+        const std::vector<Trade> &trades,
+        const RollingIndicatorColumns *indicators,
+        const std::filesystem::path &output_path)
     {
         auto t0 = std::chrono::high_resolution_clock::now();
         const size_t n = trades.size();
@@ -125,15 +156,26 @@ namespace MarketStream
         //   difference is negligible (Parquet RLE compresses both to ~0.1 MB).
         //   Using int32 gives us the simpler, stable Arrow 23 API.
         // ─────────────────────────────────────────────────────────────────────
-        auto schema = arrow::schema({arrow::field("trade_id", arrow::uint64()),
-                                     arrow::field("order_id", arrow::uint64()),
-                                     arrow::field("timestamp", arrow::int64()), // nanoseconds since epoch
-                                     arrow::field("symbol", arrow::dictionary(arrow::int8(), arrow::utf8())),
-                                     arrow::field("price", arrow::float64()),
-                                     arrow::field("volume", arrow::uint32()),
-                                     arrow::field("side", arrow::dictionary(arrow::int8(), arrow::utf8())),
-                                     arrow::field("type", arrow::dictionary(arrow::int8(), arrow::utf8())),
-                                     arrow::field("is_pro", arrow::boolean())});
+        arrow::FieldVector fields{arrow::field("trade_id", arrow::uint64()),
+                                  arrow::field("order_id", arrow::uint64()),
+                                  arrow::field("timestamp", arrow::int64()), // nanoseconds since epoch
+                                  arrow::field("symbol", arrow::dictionary(arrow::int8(), arrow::utf8())),
+                                  arrow::field("price", arrow::float64()),
+                                  arrow::field("volume", arrow::uint32()),
+                                  arrow::field("side", arrow::dictionary(arrow::int8(), arrow::utf8())),
+                                  arrow::field("type", arrow::dictionary(arrow::int8(), arrow::utf8())),
+                                  arrow::field("is_pro", arrow::boolean())};
+
+        // Feature columns go AFTER the trade columns, so readers that only
+        // know the original 9-column layout still find every column by name.
+        if (indicators)
+        {
+            const std::string n_suffix = "_" + std::to_string(indicators->period);
+            fields.push_back(arrow::field("sma" + n_suffix, arrow::float64()));
+            fields.push_back(arrow::field("rsi" + n_suffix, arrow::float64()));
+            fields.push_back(arrow::field("vwap", arrow::float64()));
+        }
+        auto schema = arrow::schema(fields);
 
         // ─────────────────────────────────────────────────────────────────────
         // STEP 2: CREATE ARRAY BUILDERS
@@ -261,11 +303,26 @@ namespace MarketStream
         // DuckDB, Polars all natively understand. ZERO copy here —
         // Table holds shared_ptrs to the same Arrays we just finalized.
         // ─────────────────────────────────────────────────────────────────────
-        auto table = arrow::Table::Make(
-            schema,
-            {trade_id_arr, order_id_arr, timestamp_arr,
-             symbol_arr, price_arr, volume_arr,
-             side_arr, type_arr, is_pro_arr});
+        arrow::ArrayVector columns{trade_id_arr, order_id_arr, timestamp_arr,
+                                   symbol_arr, price_arr, volume_arr,
+                                   side_arr, type_arr, is_pro_arr};
+
+        // ── Indicator feature columns ─────────────────────────────────────────
+        // Already columnar (vector<double>) — AppendValues() is one memcpy
+        // per column, no per-row loop needed.
+        if (indicators)
+        {
+            for (const std::vector<double> *col : {&indicators->sma, &indicators->rsi, &indicators->vwap})
+            {
+                arrow::DoubleBuilder builder(arrow::default_memory_pool());
+                THROW_IF_NOT_OK(builder.AppendValues(*col));
+                std::shared_ptr<arrow::Array> arr;
+                THROW_IF_NOT_OK(builder.Finish(&arr));
+                columns.push_back(std::move(arr));
+            }
+        }
+
+        auto table = arrow::Table::Make(schema, columns);
 
         std::cout << "[PARQUET] Arrow table built. "
                   << table->num_rows() << " rows x "
@@ -46,6 +46,7 @@
 #include <vector>
 #include <filesystem>
 #include "../model/Trade.hpp"
+#include "../indicators/TechnicalIndicators.hpp" // RollingIndicatorColumns
 
 namespace MarketStream
 {
@@ -75,6 +76,26 @@ namespace MarketStream
             const std::vector<Trade> &trades,
             const std::filesystem::path &output_path);
 
+        // ====================================================================
+        // write() — trades + per-trade indicator feature columns
+        // ====================================================================
+        // Same file as above plus three float64 columns after the trade columns:
+        //   sma_<N>, rsi_<N>, vwap       (N = indicators.period)
+        // Row i of each column belongs to trades[i] — the output of
+        // TechnicalIndicators::compute_rolling() on the same vector.
+        //
+        // Research jobs then read features with the trades:
+        //   pd.read_parquet(f, columns=["timestamp", "price", "sma_5", "rsi_5"])
+        // instead of recomputing rolling windows for every trade in pandas.
+        //
+        // THROWS: std::invalid_argument if indicators.size() != trades.size()
+        // ====================================================================
+        [[nodiscard]]
+        static long long write(
+            const std::vector<Trade> &trades,
+            const RollingIndicatorColumns &indicators,
+            const std::filesystem::path &output_path);
+
         // ====================================================================
         // make_output_path()
         // ====================================================================
@@ -87,6 +108,13 @@ namespace MarketStream
         // ====================================================================
         static std::filesystem::path make_output_path(
             const std::filesystem::path &directory = ".");
+
+    private:
+        // Shared implementation. indicators == nullptr → trade columns only.
+        static long long write_impl(
+            const std::vector<Trade> &trades,
+            const RollingIndicatorColumns *indicators,
+            const std::filesystem::path &output_path);
     };
 
 } // namespace MarketStream
\ No newline at end of file
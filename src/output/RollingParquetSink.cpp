@@ -0,0 +1,342 @@
+#include "RollingParquetSink.hpp"
+#include "../threading/ThreadPlacement.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <deque>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <ctime>
+
+#include <arrow/api.h>
+#include <arrow/io/api.h>
+#include <parquet/arrow/writer.h>
+#include <parquet/properties.h>
+
+// Same contract as ParquetWriter.cpp: Arrow Status → std::runtime_error
+#define THROW_IF_NOT_OK(expr)                             \
+    do                                                    \
+    {                                                     \
+        ::arrow::Status _s = (expr);                      \
+        if (!_s.ok())                                     \
+        {                                                 \
+            throw std::runtime_error(                     \
+                std::string("[PARQUET ERROR] ") + #expr + \
+                " -> " + _s.ToString());                  \
+        }                                                 \
+    } while (0)
+
+namespace MarketStream
+{
+
+    // =========================================================================
+    // Impl — everything that needs Arrow
+    // =========================================================================
+    struct RollingParquetSink::Impl
+    {
+        explicit Impl(RollingParquetConfig cfg) : config(std::move(cfg)) {}
+
+        RollingParquetConfig config;
+
+        // WHY Dictionary32 (not the adaptive StringDictionaryBuilder)?
+        // The adaptive builder picks int8 / int16 indices per batch. Every
+        // row group of one file must match ONE schema, so the index width
+        // is fixed here.
+        std::shared_ptr<arrow::Schema> schema = arrow::schema({
+            arrow::field("trade_id", arrow::uint64()),
+            arrow::field("order_id", arrow::uint64()),
+            arrow::field("timestamp", arrow::int64()),
+            arrow::field("symbol", arrow::dictionary(arrow::int32(), arrow::utf8())),
+            arrow::field("price", arrow::float64()),
+            arrow::field("volume", arrow::uint32()),
+            arrow::field("side", arrow::dictionary(arrow::int32(), arrow::utf8())),
+            arrow::field("type", arrow::dictionary(arrow::int32(), arrow::utf8())),
+            arrow::field("is_pro", arrow::boolean()),
+        });
+
+        // ── Collector: column builders for the row group being filled ────────
+        arrow::UInt64Builder trade_id{arrow::default_memory_pool()};
+        arrow::UInt64Builder order_id{arrow::default_memory_pool()};
+        arrow::Int64Builder timestamp{arrow::default_memory_pool()};
+        arrow::StringDictionary32Builder symbol{arrow::default_memory_pool()};
+        arrow::DoubleBuilder price{arrow::default_memory_pool()};
+        arrow::UInt32Builder volume{arrow::default_memory_pool()};
+        arrow::StringDictionary32Builder side{arrow::default_memory_pool()};
+        arrow::StringDictionary32Builder type{arrow::default_memory_pool()};
+        arrow::BooleanBuilder is_pro{arrow::default_memory_pool()};
+        size_t group_rows = 0;
+        std::chrono::steady_clock::time_point group_oldest;
+
+        void append(const Trade &t)
+        {
+            THROW_IF_NOT_OK(trade_id.Append(t.trade_id));
+            THROW_IF_NOT_OK(order_id.Append(t.order_id));
+            THROW_IF_NOT_OK(timestamp.Append(static_cast<int64_t>(t.timestamp)));
+            THROW_IF_NOT_OK(symbol.Append(std::string_view(t.symbol.data(), t.symbol.size())));
+            THROW_IF_NOT_OK(price.Append(t.price));
+            THROW_IF_NOT_OK(volume.Append(t.volume));
+            THROW_IF_NOT_OK(side.Append(std::string_view(&t.side, 1)));
+            THROW_IF_NOT_OK(type.Append(std::string_view(&t.type, 1)));
+            THROW_IF_NOT_OK(is_pro.Append(t.is_pro));
+            ++group_rows;
+        }
+
+        // Builders → immutable RecordBatch; Finish() also resets each builder
+        std::shared_ptr<arrow::RecordBatch> finish_group()
+        {
+            arrow::ArrayVector columns(9);
+            THROW_IF_NOT_OK(trade_id.Finish(&columns[0]));
+            THROW_IF_NOT_OK(order_id.Finish(&columns[1]));
+            THROW_IF_NOT_OK(timestamp.Finish(&columns[2]));
+            THROW_IF_NOT_OK(symbol.Finish(&columns[3]));
+            THROW_IF_NOT_OK(price.Finish(&columns[4]));
+            THROW_IF_NOT_OK(volume.Finish(&columns[5]));
+            THROW_IF_NOT_OK(side.Finish(&columns[6]));
+            THROW_IF_NOT_OK(type.Finish(&columns[7]));
+            THROW_IF_NOT_OK(is_pro.Finish(&columns[8]));
+            auto batch = arrow::RecordBatch::Make(schema, static_cast<int64_t>(group_rows), std::move(columns));
+            group_rows = 0;
+            return batch;
+        }
+
+        // ── Hand-off: finished row groups waiting for the writer ─────────────
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<std::shared_ptr<arrow::RecordBatch>> pending;
+        bool collector_done = false;
+
+        // ── Writer: the open file ────────────────────────────────────────────
+        std::shared_ptr<arrow::io::FileOutputStream> outfile;
+        std::unique_ptr<parquet::arrow::FileWriter> writer;
+        std::filesystem::path tmp_path, final_path;
+        std::chrono::steady_clock::time_point file_opened;
+        size_t file_seq = 0;
+
+        RollingParquetStats stats;
+
+        void open_file()
+        {
+            auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+            std::tm tm_now{};
+#ifdef _WIN32
+            localtime_s(&tm_now, &now);
+#else
+            localtime_r(&now, &tm_now);
+#endif
+            std::ostringstream name;
+            name << config.prefix << '_' << std::put_time(&tm_now, "%Y%m%d_%H%M%S")
+                 << '_' << std::setw(4) << std::setfill('0') << file_seq++ << ".parquet";
+            final_path = config.directory / name.str();
+            tmp_path = final_path;
+            tmp_path += ".tmp";
+
+            auto opened = arrow::io::FileOutputStream::Open(tmp_path.string());
+            if (!opened.ok())
+                throw std::runtime_error("[PARQUET ERROR] Cannot create " + tmp_path.string() +
+                                         " -> " + opened.status().ToString());
+            outfile = opened.ValueOrDie();
+
+            auto writer_props = parquet::WriterProperties::Builder()
+                                    .compression(arrow::Compression::SNAPPY)
+                                    ->build();
+            auto arrow_props = parquet::ArrowWriterProperties::Builder()
+                                   .store_schema()
+                                   ->build();
+            auto made = parquet::arrow::FileWriter::Open(*schema, arrow::default_memory_pool(),
+                                                         outfile, writer_props, arrow_props);
+            if (!made.ok())
+                throw std::runtime_error("[PARQUET ERROR] FileWriter::Open -> " + made.status().ToString());
+            writer = std::move(made).ValueOrDie();
+            file_opened = std::chrono::steady_clock::now();
+        }
+
+        // Footer, close, then the atomic rename that publishes the file
+        void close_file()
+        {
+            if (!writer)
+                return;
+            THROW_IF_NOT_OK(writer->Close());
+            THROW_IF_NOT_OK(outfile->Close());
+            writer.reset();
+            outfile.reset();
+            std::filesystem::rename(tmp_path, final_path);
+            ++stats.files_closed;
+            std::cout << "[PARQUET-LIVE] Closed " << final_path.filename().string() << "\n";
+        }
+
+        void write_group(const std::shared_ptr<arrow::RecordBatch> &batch)
+        {
+            if (!writer)
+                open_file();
+
+            auto t0 = std::chrono::steady_clock::now();
+            auto table = arrow::Table::FromRecordBatches(schema, {batch});
+            if (!table.ok())
+                throw std::runtime_error("[PARQUET ERROR] " + table.status().ToString());
+            // chunk_size = the batch → exactly one row group per batch
+            THROW_IF_NOT_OK(writer->WriteTable(**table, batch->num_rows()));
+            stats.encode_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   std::chrono::steady_clock::now() - t0)
+                                   .count();
+            stats.rows_written += static_cast<size_t>(batch->num_rows());
+            ++stats.row_groups;
+
+            auto size = outfile->Tell();
+            if (size.ok() && static_cast<size_t>(*size) >= config.max_file_bytes)
+                close_file();
+        }
+
+        bool file_expired() const
+        {
+            return writer && std::chrono::steady_clock::now() - file_opened >= config.max_file_age;
+        }
+    };
+
+    // =========================================================================
+    // RollingParquetSink
+    // =========================================================================
+    RollingParquetSink::RollingParquetSink(RollingParquetConfig config)
+        : queue_(std::make_unique<Queue>()),
+          impl_(std::make_unique<Impl>(std::move(config)))
+    {
+    }
+
+    RollingParquetSink::~RollingParquetSink() { stop(); }
+
+    void RollingParquetSink::start()
+    {
+        std::filesystem::create_directories(impl_->config.directory);
+        running_.store(true, std::memory_order_release);
+        // Helper placement: compression must not share the consumer's core
+        // it would otherwise inherit — that would backpressure intake
+        collector_ = std::thread([this]()
+                                 {
+                                     ThreadPlacement::apply(ThreadRole::Helper);
+                                     collect_loop(); });
+        writer_ = std::thread([this]()
+                              {
+                                  ThreadPlacement::apply(ThreadRole::Helper);
+                                  write_loop(); });
+    }
+
+    void RollingParquetSink::stop()
+    {
+        if (!running_.exchange(false, std::memory_order_acq_rel))
+            return;
+        if (collector_.joinable())
+            collector_.join();
+        if (writer_.joinable())
+            writer_.join();
+        impl_->stats.stalls = stalls_;
+        impl_->stats.dropped = dropped_;
+        impl_->stats.failed = failed_.load(std::memory_order_relaxed);
+    }
+
+    RollingParquetStats RollingParquetSink::stats() const
+    {
+        return impl_->stats;
+    }
+
+    // ── Collector thread ─────────────────────────────────────────────────────
+    void RollingParquetSink::collect_loop()
+    {
+        Impl &im = *impl_;
+        auto hand_off = [this, &im]()
+        {
+            auto batch = im.finish_group();
+            std::lock_guard<std::mutex> lock(im.mutex);
+            if (failed_.load(std::memory_order_relaxed))
+                return; // writer gave up — nobody would ever pop it
+            im.pending.push_back(std::move(batch));
+            im.stats.max_pending_row_groups = std::max(im.stats.max_pending_row_groups, im.pending.size());
+            im.cv.notify_one();
+        };
+
+        try
+        {
+            while ((running_.load(std::memory_order_acquire) || !queue_->empty()) &&
+                   !failed_.load(std::memory_order_relaxed))
+            {
+                auto item = queue_->try_pop();
+                if (item)
+                {
+                    if (im.group_rows == 0)
+                        im.group_oldest = std::chrono::steady_clock::now();
+                    im.append(*item);
+                    if (im.group_rows >= im.config.row_group_rows)
+                        hand_off();
+                    continue;
+                }
+                if (im.group_rows > 0 &&
+                    std::chrono::steady_clock::now() - im.group_oldest >= im.config.row_group_age)
+                    hand_off();
+                else
+                    // Idle: row groups are flushed on a ~1 s scale, so a short
+                    // sleep costs nothing and frees the core for the consumer.
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+            if (im.group_rows > 0 && !failed_.load(std::memory_order_relaxed))
+                hand_off();
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "[PARQUET-LIVE ERROR] Collector: " << e.what() << "\n";
+            failed_.store(true, std::memory_order_relaxed); // offer() stops queueing
+        }
+
+        std::lock_guard<std::mutex> lock(im.mutex);
+        im.collector_done = true;
+        im.cv.notify_one();
+    }
+
+    // ── Writer thread ────────────────────────────────────────────────────────
+    void RollingParquetSink::write_loop()
+    {
+        Impl &im = *impl_;
+        try
+        {
+            for (;;)
+            {
+                std::shared_ptr<arrow::RecordBatch> batch;
+                {
+                    std::unique_lock<std::mutex> lock(im.mutex);
+                    // Wake for a row group, the end, or — with a file open —
+                    // its rotation deadline, so a quiet feed still rotates.
+                    auto ready = [&im]()
+                    { return !im.pending.empty() || im.collector_done; };
+                    if (im.writer)
+                        im.cv.wait_until(lock, im.file_opened + im.config.max_file_age, ready);
+                    else
+                        im.cv.wait(lock, ready);
+
+                    if (!im.pending.empty())
+                    {
+                        batch = std::move(im.pending.front());
+                        im.pending.pop_front();
+                    }
+                    else if (im.collector_done)
+                        break;
+                }
+
+                if (batch)
+                    im.write_group(batch); // outside the lock: collector never waits on Snappy
+                if (im.file_expired())
+                    im.close_file();
+            }
+            im.close_file();
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "[PARQUET-LIVE ERROR] Writer: " << e.what() << "\n";
+            // Stop accepting row groups and free the backlog — otherwise
+            // pending grows for the rest of the run with nothing to drain it
+            std::lock_guard<std::mutex> lock(im.mutex);
+            failed_.store(true, std::memory_order_relaxed);
+            im.pending.clear();
+        }
+    }
+
+} // namespace MarketStream
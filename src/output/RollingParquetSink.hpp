@@ -0,0 +1,141 @@
+#pragma once
+
+// ============================================================================
+// RollingParquetSink — Continuous Parquet output for the live feed
+// ============================================================================
+//
+// WHY NOT ParquetWriter::write()?
+// write() takes a COMPLETE vector<Trade> and produces ONE file. A live feed
+// never completes. We need files that appear while the feed runs, each one
+// closed and readable, without the feed ever waiting on Parquet.
+//
+// THREE THREADS, TWO HAND-OFFS:
+//
+//   consumer (hot)        collector                     writer
+//   ──────────────        ─────────                     ──────
+//   offer(tick) ──SPSC──► append to column builders
+//                         row group full / old? ──────► encode + Snappy-compress
+//                         Finish() → RecordBatch  deque  as ONE row group
+//                                                        file big / old? rotate
+//
+//   • offer() is one SPSC push — no Arrow, no allocation on the hot thread.
+//   • The collector only appends to builders: cheap, steady, keeps the SPSC
+//     queue empty.
+//   • Compression runs on the writer. If it falls behind, finished row groups
+//     wait in the deque (max_pending_row_groups in stats) — memory absorbs
+//     the burst; tick intake is never backpressured by Parquet.
+//
+// ROW GROUPS: flushed at row_group_rows rows OR when the oldest row is
+// row_group_age old — a quiet feed still produces data readers can see.
+//
+// FILE ROTATION + ATOMIC RENAME:
+// Each file is written as "<name>.parquet.tmp". When it reaches
+// max_file_bytes or max_file_age, the footer is written (Close) and the file
+// is renamed to "<name>.parquet". rename() within a directory is atomic:
+// a reader globbing *.parquet sees either no file or a complete one — never
+// a file without its footer.
+//
+// FAILURE: an Arrow/IO error on either thread sets failed_. From then on
+// offer() drops and counts the tick (same rule as TickJournal::append — a
+// broken side output must not stall the live feed), the collector stops
+// building row groups and the writer discards its backlog. The open .tmp file
+// is left unpublished: its footer was never written.
+// ============================================================================
+
+#include <string>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <filesystem>
+#include "../model/Trade.hpp"
+#include "../threading/SPSCQueue.hpp"
+
+namespace MarketStream
+{
+
+    struct RollingParquetConfig
+    {
+        std::filesystem::path directory = ".";
+        std::string prefix = "trades_live"; // trades_live_YYYYMMDD_HHMMSS_NNNN.parquet
+        size_t row_group_rows = 100'000;
+        std::chrono::milliseconds row_group_age{1000};
+        std::chrono::seconds max_file_age{300};    // rotate every 5 minutes ...
+        size_t max_file_bytes = 128 * 1024 * 1024; // ... or 128 MB, whichever first
+    };
+
+    struct RollingParquetStats
+    {
+        size_t rows_written = 0;
+        size_t row_groups = 0;
+        size_t files_closed = 0;
+        size_t stalls = 0;                 // offer() found the SPSC queue full
+        size_t max_pending_row_groups = 0; // writer backlog high-water mark
+        long long encode_ns = 0;           // writer time in Parquet encode/compress
+        size_t dropped = 0;                // offered after the sink failed — never written
+        bool failed = false;
+    };
+
+    class RollingParquetSink
+    {
+    public:
+        static constexpr size_t QUEUE_CAPACITY = 65536;
+
+        explicit RollingParquetSink(RollingParquetConfig config = {});
+        ~RollingParquetSink();
+
+        RollingParquetSink(const RollingParquetSink &) = delete;
+        RollingParquetSink &operator=(const RollingParquetSink &) = delete;
+
+        void start();
+
+        // Drains the queue, writes the last row group, closes + renames the
+        // open file, joins both threads.
+        void stop();
+
+        // Hot path — call from ONE thread only (SPSC contract). Once the sink
+        // has failed nothing drains the queue, so the tick is dropped instead.
+        void offer(const Trade &t)
+        {
+            if (failed_.load(std::memory_order_relaxed))
+            {
+                ++dropped_;
+                return;
+            }
+            if (queue_->try_push(t))
+                return;
+            ++stalls_;
+            while (!queue_->try_push(t))
+            {
+                if (failed_.load(std::memory_order_relaxed))
+                {
+                    ++dropped_;
+                    return;
+                }
+                std::this_thread::yield();
+            }
+        }
+
+        [[nodiscard]] bool failed() const { return failed_.load(std::memory_order_relaxed); }
+
+        // Valid after stop()
+        [[nodiscard]] RollingParquetStats stats() const;
+
+    private:
+        struct Impl; // Arrow / Parquet state — kept out of this header
+        using Queue = SPSCQueue<Trade, QUEUE_CAPACITY>;
+
+        void collect_loop();
+        void write_loop();
+
+        std::unique_ptr<Queue> queue_;
+        std::unique_ptr<Impl> impl_;
+        std::atomic<bool> running_{false};
+        std::atomic<bool> failed_{false};
+        std::thread collector_;
+        std::thread writer_;
+        size_t stalls_ = 0;  // producer thread only
+        size_t dropped_ = 0; // producer thread only
+    };
+
+} // namespace MarketStream
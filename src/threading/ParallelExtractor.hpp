@@ -0,0 +1,209 @@
+#pragma once
+
+// ============================================================================
+// ParallelExtractor — Binary COPY TO across N database connections
+// ============================================================================
+//
+// The reverse of ParallelLoader: pull a (symbols, time range) selection back
+// out of trades for a backfill — recompute indicators, rewrite Parquet.
+//
+// WHY SEVERAL CONNECTIONS?
+// One COPY TO stream is one server backend: it scans, formats and sends on a
+// single core. N streams over disjoint time slices run N backends at once,
+// and the client decodes N streams on N threads.
+//
+//   0. export_snapshot()               → one snapshot, held open for the run
+//   1. extract_bounds(query)           → [lo, hi] of the matching rows
+//   2. split [lo, hi] into N × SLICES_PER_THREAD equal time slices
+//   3. ThreadPool(N): one extract_range() per slice, own connection each
+//
+// Bounds and every slice read the SAME snapshot: a load committing while the
+// extract runs is invisible to all of them, not just to the later slices.
+//
+// WHY MORE SLICES THAN THREADS?
+// Trades are not spread evenly over a day — the open and close are dense,
+// midday is thin. Equal-width slices hold unequal row counts; with 4 slices
+// per thread, a thread that finishes a thin slice takes the next one from
+// the pool's queue, so no thread idles while another scans the open.
+//
+// TWO WAYS TO CONSUME:
+//   collect(conn, query, N)         → std::vector<Trade>, slices concatenated
+//                                     in time order (ParquetWriter, indicators)
+//   stream(conn, query, N, on_batch) → each decoded batch handed over as it
+//                                     arrives, one batch at a time (mutex);
+//                                     memory stays at a few batches
+// Within a slice rows arrive in heap order — sort (ParallelRadixSort) before
+// anything that needs per-symbol time order.
+// ============================================================================
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <future>
+#include <chrono>
+#include <functional>
+#include <tuple>     // std::tie — extract_bounds() pair
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include "../model/Trade.hpp"
+#include "../database/DatabaseLoader.hpp"
+#include "ThreadPool.hpp"
+
+namespace MarketStream
+{
+
+    class ParallelExtractor
+    {
+    public:
+        static constexpr size_t SLICES_PER_THREAD = 4;
+
+        // ====================================================================
+        // stream() — batches to on_batch as they are decoded
+        // ====================================================================
+        // on_batch is never called by two threads at once. Batches from
+        // different slices interleave, so the overall order is arbitrary.
+        // Returns totals: rows, binary bytes, wall time, summed server wait.
+        // ====================================================================
+        static CopyStreamStats stream(
+            const std::string &conn_str,
+            const ExtractQuery &query,
+            size_t num_threads,
+            const DatabaseLoader::TradeBatchFn &on_batch)
+        {
+            std::mutex sink_mutex;
+            return run(conn_str, query, num_threads,
+                       [&](size_t, std::vector<Trade> &&batch)
+                       {
+                           std::lock_guard<std::mutex> lock(sink_mutex);
+                           on_batch(std::move(batch));
+                       });
+        }
+
+        // ====================================================================
+        // collect() — every matching row in one vector
+        // ====================================================================
+        // Each slice appends to its OWN vector (no lock: one task per slice),
+        // then the slices are concatenated in time order.
+        // ====================================================================
+        static std::vector<Trade> collect(
+            const std::string &conn_str,
+            const ExtractQuery &query,
+            size_t num_threads = 4,
+            CopyStreamStats *stats_out = nullptr)
+        {
+            num_threads = std::max<size_t>(1, num_threads);
+            std::vector<std::vector<Trade>> slices(num_threads * SLICES_PER_THREAD);
+            const CopyStreamStats stats = run(
+                conn_str, query, num_threads,
+                [&slices](size_t slice, std::vector<Trade> &&batch)
+                {
+                    auto &dst = slices[slice];
+                    if (dst.empty())
+                        dst = std::move(batch);
+                    else
+                        dst.insert(dst.end(), std::make_move_iterator(batch.begin()),
+                                   std::make_move_iterator(batch.end()));
+                });
+
+            std::vector<Trade> trades;
+            trades.reserve(static_cast<size_t>(stats.rows));
+            for (auto &slice : slices)
+                trades.insert(trades.end(), std::make_move_iterator(slice.begin()),
+                              std::make_move_iterator(slice.end()));
+            if (stats_out)
+                *stats_out = stats;
+            return trades;
+        }
+
+    private:
+        using SliceBatchFn = std::function<void(size_t slice, std::vector<Trade> &&batch)>;
+
+        static CopyStreamStats run(
+            const std::string &conn_str,
+            const ExtractQuery &query,
+            size_t num_threads,
+            const SliceBatchFn &on_batch)
+        {
+            num_threads = std::max<size_t>(1, num_threads);
+            const auto wall_start = std::chrono::steady_clock::now();
+
+            // ----------------------------------------------------------------
+            // STEP 1: Actual time span of the selection
+            // ----------------------------------------------------------------
+            // Held until every slice is done: the snapshot lives as long as
+            // its exporting transaction.
+            DatabaseLoader bounds_loader(conn_str);
+            const DatabaseLoader::ExtractSnapshot snapshot = bounds_loader.export_snapshot();
+            ExtractQuery pinned = query;
+            pinned.snapshot = snapshot.id;
+
+            long long lo = 0, hi = -1;
+            std::tie(lo, hi) = bounds_loader.extract_bounds(pinned);
+            if (hi < lo)
+            {
+                std::cout << "[EXTRACT] No rows match.\n";
+                return {};
+            }
+
+            // ----------------------------------------------------------------
+            // STEP 2: Equal-width time slices over [lo, hi]
+            // ----------------------------------------------------------------
+            // Slice i covers [lo + span·i/S, lo + span·(i+1)/S); the last one
+            // ends at hi + 1 so the largest timestamp is included. Computed
+            // in long double: span·i overflows 64 bits for multi-day spans.
+            // ----------------------------------------------------------------
+            const size_t slice_count = num_threads * SLICES_PER_THREAD;
+            const long double span = static_cast<long double>(hi) - static_cast<long double>(lo) + 1.0L;
+            std::vector<ExtractQuery> slices(slice_count, pinned);
+            for (size_t i = 0; i < slice_count; ++i)
+            {
+                slices[i].from_ns = lo + static_cast<long long>(span * i / slice_count);
+                slices[i].to_ns = i + 1 == slice_count
+                                      ? hi + 1
+                                      : lo + static_cast<long long>(span * (i + 1) / slice_count);
+            }
+
+            std::cout << "[EXTRACT] Strategy: " << num_threads << " connections × "
+                      << SLICES_PER_THREAD << " time slices from " << query.table << "\n";
+
+            // ----------------------------------------------------------------
+            // STEP 3: One binary COPY TO per slice on the pool
+            // ----------------------------------------------------------------
+            ThreadPool pool(num_threads);
+            std::vector<std::future<CopyStreamStats>> futures;
+            futures.reserve(slice_count);
+            for (size_t i = 0; i < slice_count; ++i)
+            {
+                futures.push_back(pool.submit(
+                    [conn_str, slice = slices[i], i, &on_batch]() -> CopyStreamStats
+                    {
+                        DatabaseLoader loader(conn_str);
+                        return loader.extract_range(slice, [&on_batch, i](std::vector<Trade> &&batch)
+                                                    { on_batch(i, std::move(batch)); });
+                    }));
+            }
+            pool.wait_all();
+
+            CopyStreamStats total;
+            for (auto &f : futures)
+            {
+                const CopyStreamStats s = f.get(); // rethrows a failed slice
+                total.rows += s.rows;
+                total.bytes += s.bytes;
+                total.wait_ns += s.wait_ns;
+            }
+            total.total_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                 std::chrono::steady_clock::now() - wall_start)
+                                 .count();
+
+            std::cout << "[EXTRACT] " << total.rows << " rows, "
+                      << std::fixed << std::setprecision(1)
+                      << static_cast<double>(total.bytes) / (1024.0 * 1024.0) << " MB binary in "
+                      << total.total_ns / 1'000'000 << "ms ("
+                      << total.mb_per_sec() << " MB/s)\n";
+            return total;
+        }
+    };
+
+} // namespace MarketStream
@@ -31,7 +31,18 @@
 // LOAD SEQUENCE (MUST follow this order):
 //   1. prepare_for_parallel_load()    ← DROP PK + index (main thread, sequential)
 //   2. Thread pool: copy_chunk × N   ← parallel COPY streams
-//   3. finalize_parallel_load()       ← ADD PRIMARY KEY + index (main thread, sequential)
+//   3. finalize_parallel_load()       ← PK + index, built concurrently on 2 connections
+//
+// APPEND MODES (LoadMode::Append / AppendRebuild / Auto):
+//   Same three steps, but the COPY streams write into the UNLOGGED staging
+//   table and finalize merges it into trades — existing rows and (for Append)
+//   existing indexes are kept. See DatabaseLoader METHOD 10-12.
+//
+// COPY ENGINES (CopyEngine, ETL_COPY_ENGINE):
+//   stream_to — pqxx::stream_to per row; the thread blocks on every full send
+//   async     — AsyncCopyWriter; encoding overlaps the socket send
+//   Each stream reports MB/s (COPY text bytes / stream time) so the two
+//   can be compared run against run on the same data.
 //
 // WHY IS prepare/finalize SEQUENTIAL?
 // Only one connection can DROP or ADD a PRIMARY KEY at a time —
@@ -43,11 +54,14 @@
 #include <vector>
 #include <span> // C++20: zero-copy view over a slice of a vector
 #include <future>
+#include <exception> // std::exception_ptr — first failed COPY stream
+#include <utility> // std::pair — indicator + order-flow save timings
 #include <chrono>
 #include <iostream>
 #include <iomanip>
 #include "../model/Trade.hpp"
 #include "../indicators/TechnicalIndicators.hpp"
+#include "../indicators/OrderFlow.hpp"
 #include "../database/DatabaseLoader.hpp"
 #include "../benchmark/Benchmarker.hpp"
 #include "ThreadPool.hpp"
@@ -65,38 +79,60 @@ namespace MarketStream
         //   conn_str    — PostgreSQL connection string (copied to each thread)
         //   trades      — full 1M trade vector (passed as const ref — no copy)
         //   indicators  — computed indicators (6-10 rows, loaded separately)
+        //   order_flow  — order-flow buckets (saved with the indicators)
         //   bench_results — vector to push timing results into
         //   num_threads — how many parallel COPY streams to use (default: 4)
+        //   mode        — Replace (default), Append, AppendRebuild or Auto
+        //   engine      — StreamTo (default) or Async COPY sender
         // ====================================================================
         static void run(
             const std::string &conn_str,
             const std::vector<Trade> &trades,
             const std::vector<IndicatorResult> &indicators,
+            const std::vector<OrderFlowBucket> &order_flow,
             std::vector<BenchmarkResult> &bench_results,
-            size_t num_threads = 4)
+            size_t num_threads = 4,
+            LoadMode mode = LoadMode::Replace,
+            CopyEngine engine = CopyEngine::StreamTo)
         {
             const size_t total_trades = trades.size();
 
+            {
+                DatabaseLoader mode_loader(conn_str);
+                mode = mode_loader.resolve_load_mode(mode, total_trades);
+            }
+            const bool append = mode == LoadMode::Append || mode == LoadMode::AppendRebuild;
+            const bool freeze = mode == LoadMode::Freeze;
+            if (freeze)
+                num_threads = 1; // FREEZE needs TRUNCATE + COPY in ONE transaction
+            const std::string target_table = append ? DatabaseLoader::STAGING_TABLE : "trades";
+            std::cout << "[PARALLEL-LOAD] Mode: " << DatabaseLoader::load_mode_name(mode)
+                      << " (COPY target: " << target_table << ")\n";
+
             std::cout << "[PARALLEL-LOAD] Strategy: " << num_threads
                       << " threads × " << (total_trades / num_threads)
                       << " rows each\n";
 
             // ----------------------------------------------------------------
-            // STEP 0: Save indicators in background (independent of trades load)
+            // STEP 0: Save indicators + order flow in background
             // ----------------------------------------------------------------
-            // Indicators are just 6-10 rows — they don't need the thread pool.
-            // Launch as a single std::async task. It runs simultaneously with
-            // everything below, completely independent.
+            // Indicators are just 6-10 rows, order flow a few thousand —
+            // neither needs the thread pool. Launch as a single std::async task
+            // that saves both, one after the other. It runs simultaneously with
+            // everything below, completely independent of the trades table.
             // ----------------------------------------------------------------
             auto future_indicators = std::async(
                 std::launch::async,
-                [conn_str, &indicators]() -> long long
+                [conn_str, &indicators, &order_flow]() -> std::pair<long long, long long>
                 {
                     auto t0 = std::chrono::high_resolution_clock::now();
                     DatabaseLoader loader(conn_str);
                     loader.save_indicators(indicators);
                     auto t1 = std::chrono::high_resolution_clock::now();
-                    return std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+                    loader.save_order_flow(order_flow);
+                    auto t2 = std::chrono::high_resolution_clock::now();
+                    return {std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count(),
+                            std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count()};
                 });
 
             // ----------------------------------------------------------------
@@ -109,10 +145,17 @@ namespace MarketStream
             //
             // After this call: table has NO primary key, NO index.
             // COPY will be pure sequential writes — maximum speed.
+            //
+            // Append modes leave trades untouched and empty the staging table.
+            // Freeze does its TRUNCATE inside the COPY transaction (STEP 3).
             // ----------------------------------------------------------------
+            if (!freeze)
             {
                 DatabaseLoader prep_loader(conn_str);
-                prep_loader.prepare_for_parallel_load();
+                if (append)
+                    prep_loader.prepare_for_append_load();
+                else
+                    prep_loader.prepare_for_parallel_load();
             }
 
             auto wall_start = std::chrono::high_resolution_clock::now();
@@ -162,7 +205,7 @@ namespace MarketStream
             ThreadPool pool(num_threads);
 
             // One future per chunk — lets us retrieve per-thread timing
-            std::vector<std::future<long long>> futures;
+            std::vector<std::future<CopyStreamStats>> futures;
             futures.reserve(num_threads);
 
             for (size_t i = 0; i < num_threads; ++i)
@@ -187,7 +230,7 @@ namespace MarketStream
 
                 futures.push_back(
                     pool.submit(
-                        [conn_str, chunk, thread_id]() -> long long
+                        [conn_str, chunk, thread_id, target_table, freeze, engine]() -> CopyStreamStats
                         {
                             auto t0 = std::chrono::high_resolution_clock::now();
 
@@ -196,16 +239,34 @@ namespace MarketStream
                             // 4 threads = 4 TCP connections to PostgreSQL.
                             // 4 independent COPY streams running simultaneously.
                             DatabaseLoader loader(conn_str);
-                            loader.copy_chunk(chunk, static_cast<int>(thread_id));
+                            CopyStreamStats stats;
+                            if (freeze)
+                                loader.freeze_load(chunk);
+                            else if (engine == CopyEngine::Async)
+                                stats = loader.copy_chunk_async(chunk, static_cast<int>(thread_id), target_table);
+                            else
+                                loader.copy_chunk(chunk, static_cast<int>(thread_id), target_table);
 
                             auto t1 = std::chrono::high_resolution_clock::now();
                             auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
 
+                            // stream_to does not expose its byte count; the
+                            // COPY text is identical, so size it here —
+                            // AFTER the timed region.
+                            if (stats.bytes == 0)
+                                stats.bytes = CopyRowEncoder::encoded_size(chunk);
+                            stats.rows = static_cast<long long>(chunk.size());
+                            stats.total_ns = ns; // connect + COPY + commit, same for both engines
+
                             std::cout << "[THREAD " << thread_id << "] COPY complete: "
                                       << chunk.size() << " rows in "
-                                      << ns / 1'000'000 << "ms\n";
+                                      << ns / 1'000'000 << "ms ("
+                                      << std::fixed << std::setprecision(1) << stats.mb_per_sec() << " MB/s";
+                            if (engine == CopyEngine::Async && !freeze)
+                                std::cout << ", socket wait " << stats.wait_ns / 1'000'000 << "ms";
+                            std::cout << ")\n";
 
-                            return ns;
+                            return stats;
                         }));
             }
 
@@ -225,53 +286,119 @@ namespace MarketStream
                                     wall_end - wall_start)
                                     .count();
 
+            // A stream that threw rethrows from get(). Look BEFORE finalize:
+            // merging staging after a failed COPY would commit a partial delta.
+            std::vector<CopyStreamStats> stream_stats;
+            stream_stats.reserve(futures.size());
+            std::exception_ptr copy_error;
+            for (auto &f : futures)
+            {
+                try
+                {
+                    stream_stats.push_back(f.get());
+                }
+                catch (...)
+                {
+                    if (!copy_error)
+                        copy_error = std::current_exception();
+                }
+            }
+            if (copy_error && append)
+            {
+                // trades is untouched — just throw away what reached staging
+                std::cerr << "[PARALLEL-LOAD] A COPY stream failed — skipping the merge, emptying "
+                          << DatabaseLoader::STAGING_TABLE << ".\n";
+                DatabaseLoader cleanup_loader(conn_str);
+                cleanup_loader.prepare_for_append_load();
+                std::rethrow_exception(copy_error);
+            }
+            if (copy_error && freeze)
+            {
+                // TRUNCATE + COPY rolled back together: trades still has its
+                // old rows AND trades_pkey. Finalize would only fail on the
+                // existing key and hide the real COPY error.
+                std::cerr << "[PARALLEL-LOAD] FREEZE COPY failed — rolled back, trades unchanged.\n";
+                std::rethrow_exception(copy_error);
+            }
+
             // ----------------------------------------------------------------
-            // STEP 5: Finalize — rebuild PRIMARY KEY and index (sequential)
+            // STEP 5: Finalize — rebuild PRIMARY KEY and index
             // ----------------------------------------------------------------
             // PostgreSQL sorts all 1M trade_ids and builds the B-tree in ONE PASS.
             // This is O(N log N) but with excellent cache behavior.
             // One sort of 1M items >> 1M individual B-tree insertions.
+            // The two indexes are built at the same time on two connections;
+            // each build is reported separately in bench_results.
+            //
+            // Append modes: merge staging → trades instead (one transaction).
+            // Replace after a failed stream still rebuilds the constraints —
+            // prepare_for_parallel_load() already truncated trades and dropped
+            // its PK; leaving it keyless would be worse — then rethrows.
             // ----------------------------------------------------------------
-            std::cout << "[PARALLEL-LOAD] All COPY streams done. Rebuilding constraints...\n";
+            std::cout << "[PARALLEL-LOAD] All COPY streams done. "
+                      << (append ? "Merging staging into trades...\n" : "Rebuilding constraints...\n");
+            IndexBuildTimings index_timings;
             {
                 DatabaseLoader fin_loader(conn_str);
-                fin_loader.finalize_parallel_load(total_trades);
+                if (append)
+                    fin_loader.finalize_append_load(mode == LoadMode::AppendRebuild);
+                else
+                    index_timings = fin_loader.finalize_parallel_load(total_trades);
             }
+            if (copy_error)
+                std::rethrow_exception(copy_error);
 
             // ----------------------------------------------------------------
             // STEP 6: Wait for indicators (probably already done by now)
             // ----------------------------------------------------------------
-            long long indics_ns = future_indicators.get();
+            auto [indics_ns, flow_ns] = future_indicators.get();
 
             // ----------------------------------------------------------------
             // STEP 7: Collect per-thread timings and push to bench_results
             // ----------------------------------------------------------------
             std::vector<long long> thread_durations;
             long long max_thread_ns = 0;
+            double stream_mb_s = 0.0;
 
-            for (size_t i = 0; i < futures.size(); ++i)
+            for (size_t i = 0; i < stream_stats.size(); ++i)
             {
-                long long ns = futures[i].get();
+                const CopyStreamStats &stats = stream_stats[i];
+                const long long ns = stats.total_ns;
                 thread_durations.push_back(ns);
                 max_thread_ns = std::max(max_thread_ns, ns);
+                stream_mb_s += stats.mb_per_sec();
 
                 bench_results.push_back({"  Thread " + std::to_string(i) + " COPY",
                                          ns,
                                          chunks[i].size()});
             }
+            if (!stream_stats.empty())
+                stream_mb_s /= static_cast<double>(stream_stats.size());
 
+            if (!append)
+            {
+                bench_results.push_back({"  PK index build", index_timings.primary_key_ns, total_trades});
+                bench_results.push_back({"  Sym/time index", index_timings.symbol_time_ns, total_trades});
+                bench_results.push_back({"  PK attach", index_timings.attach_pk_ns, 0});
+                bench_results.push_back({"  Index wall", index_timings.wall_ns, total_trades});
+            }
             bench_results.push_back({"  Indics save", indics_ns, indicators.size()});
+            bench_results.push_back({"  Flow save", flow_ns, order_flow.size()});
             bench_results.push_back({"PARALLEL DB Total", wall_ns, total_trades});
 
-            // Summary
-            double speedup_vs_single = 4.2 * 1e9 / static_cast<double>(wall_ns);
+            // Summary — compare strategies with db_load_benchmark, not a fixed baseline
+            const double rows_per_sec = wall_ns > 0
+                                            ? static_cast<double>(total_trades) * 1e9 / static_cast<double>(wall_ns)
+                                            : 0.0;
 
             std::cout << "[PARALLEL-LOAD] Complete.\n";
             std::cout << "[PARALLEL-LOAD]   Total rows loaded   : " << total_trades << "\n";
             std::cout << "[PARALLEL-LOAD]   Wall time (COPY only): " << wall_ns / 1'000'000 << "ms\n";
-            std::cout << "[PARALLEL-LOAD]   vs single-thread    : ~4200ms\n";
-            std::cout << "[PARALLEL-LOAD]   Speedup             : "
-                      << std::fixed << std::setprecision(2) << speedup_vs_single << "x\n";
+            std::cout << "[PARALLEL-LOAD]   COPY engine         : "
+                      << (freeze ? "freeze" : DatabaseLoader::copy_engine_name(engine))
+                      << ", " << std::fixed << std::setprecision(1) << stream_mb_s << " MB/s per stream\n";
+            std::cout << "[PARALLEL-LOAD]   Throughput          : "
+                      << std::fixed << std::setprecision(0) << rows_per_sec << " rows/sec\n";
         }
     };
 
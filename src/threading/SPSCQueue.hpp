@@ -94,8 +94,18 @@ namespace MarketStream
 // Cache line size is a hardware constant — never changes during program execution.
 // constexpr = computed at compile time = zero runtime cost.
 // The compiler can use this to layout structs optimally.
+//
+// MARKETSTREAM_CACHE_LINE overrides it (cmake -DMARKETSTREAM_CACHE_LINE=128).
+// The compiler's constant is the L1 line, but Intel's adjacent-line
+// prefetcher pulls lines in 128-byte pairs — two hot variables 64 bytes
+// apart can still interfere. false_sharing_benchmark sweep measures which
+// separation this host actually needs.
 // ============================================================================
-#ifdef __cpp_lib_hardware_interference_size
+#if defined(MARKETSTREAM_CACHE_LINE)
+    static constexpr size_t CACHE_LINE = MARKETSTREAM_CACHE_LINE;
+    static_assert(CACHE_LINE >= 16 && (CACHE_LINE & (CACHE_LINE - 1)) == 0,
+                  "MARKETSTREAM_CACHE_LINE must be a power of 2, at least 16");
+#elif defined(__cpp_lib_hardware_interference_size)
     static constexpr size_t CACHE_LINE = std::hardware_destructive_interference_size;
 #else
     // Fallback for MSVC / older GCC where the constant isn't defined
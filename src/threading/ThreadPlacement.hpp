@@ -0,0 +1,564 @@
+#pragma once
+
+// ============================================================================
+// ThreadPlacement — CPU pinning and NUMA-aware placement for pipeline threads
+// ============================================================================
+//
+// WHY PIN AT ALL?
+// By default the scheduler puts each thread wherever a core is free and may
+// move it at any time. That hurts the feed path in two ways:
+//
+//   1. Migration — a thread moved to another core starts with cold L1/L2.
+//   2. Cross-socket hand-off — on a dual-socket box the TickClient (SPSC
+//      producer) and the consumer can land on different sockets. Every
+//      head_/tail_ update and every Trade slot then crosses the socket
+//      interconnect (~100+ ns per cache-line transfer instead of ~40 ns
+//      through the shared L3).
+//
+// Pinning fixes both: producer and consumer on two cores of ONE socket,
+// sharing its L3, and neither ever migrates.
+//
+// WHAT ABOUT MEMORY? (first touch)
+// Linux places a page on the NUMA node of the thread that FIRST WRITES it,
+// not the thread that called malloc. SPSCQueue's constructor writes every
+// slot, so whichever thread constructs the queue decides its node. The
+// consumer pins itself BEFORE constructing the queue (and its own batch
+// buffers) — the ring then lives on the consumer's node, next to the L3
+// both threads share. No libnuma needed.
+//
+// CONFIGURATION — ETL_CPU_PLAN (unset = no pinning, the default):
+//
+//   auto                  feed, consumer(s), server on different physical
+//                         cores of the socket with the most cores — one core
+//                         per ETL_SHARDS consumer; pool workers on the
+//                         remaining cores of that socket
+//   auto;smt              same, but consumer on the feed core's SMT sibling
+//                         (shared L1/L2 — lowest hand-off latency, but the
+//                         two threads compete for one core's execution units)
+//   feed=2;consumer=3     explicit CPU lists per role: feed, consumer,
+//   server=4;pool=5-8,12  server, pool. Roles not named stay unpinned,
+//                         or take their auto placement if 'auto' is present
+//   fifo | fifo=80        feed thread runs SCHED_FIFO (default priority 50).
+//                         Needs CAP_SYS_NICE / rtprio limit; a refusal is
+//                         logged and the thread keeps running as SCHED_OTHER
+//
+//   Tokens are ';'-separated — quote the value in the shell:
+//     ETL_CPU_PLAN='auto;fifo' ./websocket_demo
+//
+// ROLES:
+//   Feed      TickClient::client_thread_ — network → SPSC producer
+//   Consumer  the thread(s) running the consume loop (websocket_demo: main,
+//             or one thread per shard); consumer i takes consumer CPU i mod N
+//   Server    TickServer::server_thread_ (demo feed source)
+//   Pool      ThreadPool workers; worker i takes pool CPU i mod N
+//   Helper    sink/journal background threads (LiveDbSink, RollingParquetSink,
+//             TickJournal): every allowed CPU except the feed, consumer and
+//             server cores
+//
+// WHY AN EXPLICIT HELPER ROLE?
+// A new thread inherits its creator's affinity. The consumer pins itself
+// and then starts the sinks — without a role of their own, the DB sink's
+// spin loop and Parquet compression would all share the consumer's ONE core.
+// Every role the plan leaves empty (e.g. no pool=) gets the helper set for
+// the same reason: never an inherited single-core mask.
+//
+// PLATFORMS:
+//   Linux    sched topology from /sys, pthread_setaffinity_np, SCHED_FIFO
+//   Windows  SetThreadAffinityMask (first 64 CPUs), THREAD_PRIORITY_TIME_CRITICAL;
+//            topology unknown — every CPU is treated as its own core, socket 0
+//   Other    placement is logged and skipped
+// ============================================================================
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <sstream>
+#include <fstream>
+#include <map>
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <cstring> // std::strerror
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX // windows.h min/max macros break std::max
+#endif
+#include <windows.h>
+#endif
+
+namespace MarketStream
+{
+
+    enum class ThreadRole
+    {
+        Feed,
+        Consumer,
+        Server,
+        Pool,
+        Helper
+    };
+
+    // One logical CPU as the kernel reports it
+    struct CpuInfo
+    {
+        int cpu = 0;     // logical CPU id (what affinity masks use)
+        int package = 0; // physical socket
+        int core = 0;    // physical core within the package (SMT siblings share it)
+        int node = 0;    // NUMA node
+    };
+
+    struct CpuPlan
+    {
+        std::vector<int> feed;
+        std::vector<int> consumer;
+        std::vector<int> server;
+        std::vector<int> pool;
+        std::vector<int> helper; // allowed CPUs minus feed/consumer/server (see plan())
+        bool fifo = false;
+        int fifo_priority = 50;
+
+        bool enabled() const
+        {
+            return fifo || !feed.empty() || !consumer.empty() || !server.empty() || !pool.empty();
+        }
+    };
+
+    class ThreadPlacement
+    {
+    public:
+        // ====================================================================
+        // plan() — ETL_CPU_PLAN, parsed once per process
+        // ====================================================================
+        // A malformed plan is reported and ignored: a typo in a tuning knob
+        // must not stop the feed.
+        // ====================================================================
+        static const CpuPlan &plan()
+        {
+            static const CpuPlan cached = []()
+            {
+                CpuPlan p;
+                const char *env = std::getenv("ETL_CPU_PLAN");
+                if (!env || !*env || std::string_view(env) == "off")
+                    return p;
+                try
+                {
+                    p = parse(env, topology(), shard_count());
+                    // Captured before anything is pinned: plan() runs first
+                    // inside the first apply()
+                    if (p.enabled())
+                        p.helper = helper_cpus(p, allowed_cpus());
+                    print_plan(p);
+                }
+                catch (const std::exception &e)
+                {
+                    std::cerr << "[CPU] Ignoring ETL_CPU_PLAN: " << e.what() << "\n";
+                    p = CpuPlan{};
+                }
+                return p;
+            }();
+            return cached;
+        }
+
+        // ====================================================================
+        // shard_count() — ETL_SHARDS, the number of consumer threads
+        // ====================================================================
+        // Read here because auto placement reserves one core per consumer.
+        // Unset/invalid = 1 (single consumer); clamped to [1, 64].
+        // ====================================================================
+        static size_t shard_count()
+        {
+            static const size_t cached = []()
+            {
+                const char *env = std::getenv("ETL_SHARDS");
+                if (!env || !*env)
+                    return size_t{1};
+                const long n = std::strtol(env, nullptr, 10);
+                return static_cast<size_t>(std::clamp(n, 1L, 64L));
+            }();
+            return cached;
+        }
+
+        // ====================================================================
+        // apply() — place the CALLING thread according to plan()
+        // ====================================================================
+        // Call first thing on the thread, before it allocates anything it
+        // will use (first touch). index selects the CPU for Pool workers and
+        // for Consumer shards.
+        // No-op when the role has no CPUs in the plan.
+        // ====================================================================
+        static void apply(ThreadRole role, size_t index = 0)
+        {
+            const CpuPlan &p = plan();
+            if (!p.enabled())
+                return;
+
+            std::vector<int> cpus;
+            switch (role)
+            {
+            case ThreadRole::Feed:     cpus = p.feed; break;
+            case ThreadRole::Consumer:
+                // One CPU per shard consumer — two shards sharing a core
+                // would serialize the work sharding exists to spread
+                if (!p.consumer.empty())
+                    cpus = {p.consumer[index % p.consumer.size()]};
+                break;
+            case ThreadRole::Server:   cpus = p.server; break;
+            case ThreadRole::Pool:
+                // One CPU per worker: a pool spread over N cores, one thread each
+                if (!p.pool.empty())
+                    cpus = {p.pool[index % p.pool.size()]};
+                break;
+            case ThreadRole::Helper: break;
+            }
+            // Unplaced role → helper set, not the creator's (possibly pinned) mask
+            if (cpus.empty())
+                cpus = p.helper;
+            if (!cpus.empty())
+                pin_current(cpus);
+            if (role == ThreadRole::Feed && p.fifo)
+                set_fifo_current(p.fifo_priority);
+        }
+
+        // ====================================================================
+        // pin_current() — restrict the calling thread to cpus
+        // ====================================================================
+        static bool pin_current(const std::vector<int> &cpus)
+        {
+#if defined(__linux__)
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (int c : cpus)
+                if (c >= 0 && c < CPU_SETSIZE)
+                    CPU_SET(c, &set);
+            const int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+            if (rc != 0)
+            {
+                std::cerr << "[CPU] Pin to " << format_list(cpus) << " failed: " << std::strerror(rc) << "\n";
+                return false;
+            }
+            return true;
+#elif defined(_WIN32)
+            DWORD_PTR mask = 0;
+            for (int c : cpus)
+                if (c >= 0 && c < 64)
+                    mask |= DWORD_PTR(1) << c;
+            if (mask == 0 || SetThreadAffinityMask(GetCurrentThread(), mask) == 0)
+            {
+                std::cerr << "[CPU] Pin to " << format_list(cpus) << " failed (error "
+                          << GetLastError() << ")\n";
+                return false;
+            }
+            return true;
+#else
+            std::cerr << "[CPU] Pinning not supported on this platform — " << format_list(cpus) << " ignored\n";
+            return false;
+#endif
+        }
+
+        // ====================================================================
+        // set_fifo_current() — real-time scheduling for the calling thread
+        // ====================================================================
+        // SCHED_FIFO: the thread runs until it blocks or yields; no SCHED_OTHER
+        // thread can preempt it. For the feed thread that means a burst is read
+        // off the socket without a time-slice interruption. It also means a
+        // spinning FIFO thread can starve its core — pin it first.
+        // ====================================================================
+        static bool set_fifo_current(int priority)
+        {
+#if defined(__linux__)
+            sched_param param{};
+            param.sched_priority = priority;
+            const int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+            if (rc != 0)
+            {
+                std::cerr << "[CPU] SCHED_FIFO " << priority << " refused: " << std::strerror(rc)
+                          << " (needs CAP_SYS_NICE or an rtprio limit) — staying SCHED_OTHER\n";
+                return false;
+            }
+            return true;
+#elif defined(_WIN32)
+            (void)priority;
+            if (!SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL))
+            {
+                std::cerr << "[CPU] THREAD_PRIORITY_TIME_CRITICAL refused (error " << GetLastError() << ")\n";
+                return false;
+            }
+            return true;
+#else
+            (void)priority;
+            std::cerr << "[CPU] Real-time scheduling not supported on this platform\n";
+            return false;
+#endif
+        }
+
+        // ====================================================================
+        // topology() — every online CPU with its package, core and node
+        // ====================================================================
+        static std::vector<CpuInfo> topology()
+        {
+            std::vector<CpuInfo> cpus;
+#if defined(__linux__)
+            const std::string root = "/sys/devices/system/cpu/";
+            std::ifstream online_file(root + "online");
+            std::string online;
+            if (online_file && std::getline(online_file, online))
+            {
+                for (int c : parse_list(online))
+                {
+                    CpuInfo info;
+                    info.cpu = c;
+                    const std::string dir = root + "cpu" + std::to_string(c) + "/";
+                    info.package = read_int(dir + "topology/physical_package_id", 0);
+                    info.core = read_int(dir + "topology/core_id", c);
+                    info.node = find_node(dir);
+                    cpus.push_back(info);
+                }
+            }
+#endif
+            if (cpus.empty())
+            {
+                // Unknown topology: one socket, every logical CPU its own core
+                const int n = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+                for (int c = 0; c < n; ++c)
+                    cpus.push_back({c, 0, c, 0});
+            }
+            return cpus;
+        }
+
+        // ====================================================================
+        // parse() — ETL_CPU_PLAN text → CpuPlan (throws std::invalid_argument)
+        // ====================================================================
+        // consumers = how many consumer cores 'auto' reserves.
+        // ====================================================================
+        static CpuPlan parse(std::string_view spec, const std::vector<CpuInfo> &topo, size_t consumers = 1)
+        {
+            CpuPlan explicit_plan;
+            bool want_auto = false, want_smt = false;
+
+            std::stringstream ss{std::string(spec)};
+            std::string token;
+            while (std::getline(ss, token, ';'))
+            {
+                token.erase(0, token.find_first_not_of(" \t"));
+                token.erase(token.find_last_not_of(" \t") + 1);
+                if (token.empty())
+                    continue;
+                const auto eq = token.find('=');
+                const std::string key = token.substr(0, eq);
+                const std::string value = eq == std::string::npos ? "" : token.substr(eq + 1);
+
+                if (key == "auto")
+                    want_auto = true;
+                else if (key == "smt")
+                    want_smt = true;
+                else if (key == "fifo")
+                {
+                    explicit_plan.fifo = true;
+                    if (!value.empty())
+                        explicit_plan.fifo_priority = std::stoi(value);
+                }
+                else if (key == "feed")
+                    explicit_plan.feed = parse_list(value);
+                else if (key == "consumer")
+                    explicit_plan.consumer = parse_list(value);
+                else if (key == "server")
+                    explicit_plan.server = parse_list(value);
+                else if (key == "pool")
+                    explicit_plan.pool = parse_list(value);
+                else
+                    throw std::invalid_argument("unknown token '" + token +
+                                                "' (auto | smt | fifo[=prio] | feed= | consumer= | server= | pool=)");
+            }
+
+            CpuPlan p = want_auto ? auto_plan(topo, want_smt, consumers) : CpuPlan{};
+            if (!explicit_plan.feed.empty())
+                p.feed = explicit_plan.feed;
+            if (!explicit_plan.consumer.empty())
+                p.consumer = explicit_plan.consumer;
+            if (!explicit_plan.server.empty())
+                p.server = explicit_plan.server;
+            if (!explicit_plan.pool.empty())
+                p.pool = explicit_plan.pool;
+            p.fifo = explicit_plan.fifo;
+            p.fifo_priority = explicit_plan.fifo_priority;
+            return p;
+        }
+
+    private:
+        // ====================================================================
+        // auto_plan() — feed/consumer/server/pool on ONE socket
+        // ====================================================================
+        // 1. Pick the package with the most physical cores.
+        // 2. Group its logical CPUs by core; the first logical CPU of each core
+        //    is its "primary", the rest are SMT siblings.
+        // 3. feed, consumers, server take the first cores (the first consumer
+        //    on the feed core's sibling with smt); the pool gets every
+        //    remaining core.
+        // SMT siblings of used cores are left idle: a pool worker sharing the
+        // feed's core would slow the feed down.
+        // ====================================================================
+        static CpuPlan auto_plan(const std::vector<CpuInfo> &topo, bool smt, size_t consumers)
+        {
+            std::map<int, std::map<int, std::vector<int>>> packages; // package → core → cpus
+            for (const auto &c : topo)
+                packages[c.package][c.core].push_back(c.cpu);
+
+            auto best = std::max_element(packages.begin(), packages.end(), [](const auto &a, const auto &b)
+                                         { return a.second.size() < b.second.size(); });
+            std::vector<std::vector<int>> cores;
+            for (auto &[core_id, cpus] : best->second)
+            {
+                std::sort(cpus.begin(), cpus.end());
+                cores.push_back(cpus);
+            }
+
+            CpuPlan p;
+            size_t next = 0;
+            auto take_core = [&]() -> std::vector<int>
+            {
+                if (next < cores.size())
+                    return {cores[next++].front()};
+                return {}; // fewer cores than roles: leave the role floating
+            };
+
+            p.feed = take_core();
+            size_t first = 0;
+            if (smt && !p.feed.empty() && cores[0].size() > 1)
+            {
+                p.consumer = {cores[0][1]};
+                first = 1;
+            }
+            for (size_t i = first; i < consumers; ++i)
+            {
+                const auto core = take_core();
+                if (core.empty())
+                    break; // out of cores: remaining shards reuse these mod N
+                p.consumer.push_back(core.front());
+            }
+            p.server = take_core();
+            while (next < cores.size())
+                p.pool.push_back(cores[next++].front());
+            return p;
+        }
+
+        // CPUs this process may run on (taskset / cgroup cpuset respected)
+        static std::vector<int> allowed_cpus()
+        {
+            std::vector<int> cpus;
+#if defined(__linux__)
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if (sched_getaffinity(0, sizeof(set), &set) == 0)
+            {
+                for (int c = 0; c < CPU_SETSIZE; ++c)
+                    if (CPU_ISSET(c, &set))
+                        cpus.push_back(c);
+            }
+#endif
+            if (cpus.empty())
+                for (const auto &c : topology())
+                    cpus.push_back(c.cpu);
+            return cpus;
+        }
+
+        // allowed minus the latency-critical cores; all of allowed if that
+        // leaves nothing (a box with fewer cores than roles)
+        static std::vector<int> helper_cpus(const CpuPlan &p, const std::vector<int> &allowed)
+        {
+            std::vector<int> out;
+            for (int c : allowed)
+            {
+                auto used = [c](const std::vector<int> &v)
+                { return std::find(v.begin(), v.end(), c) != v.end(); };
+                if (!used(p.feed) && !used(p.consumer) && !used(p.server))
+                    out.push_back(c);
+            }
+            return out.empty() ? allowed : out;
+        }
+
+        static void print_plan(const CpuPlan &p)
+        {
+            std::cout << "[CPU] Placement: feed=" << format_list(p.feed)
+                      << " consumer=" << format_list(p.consumer)
+                      << " server=" << format_list(p.server)
+                      << " pool=" << format_list(p.pool)
+                      << " helpers=" << format_list(p.helper)
+                      << (p.fifo ? " fifo=" + std::to_string(p.fifo_priority) : std::string()) << "\n";
+
+            // The hand-off the pinning exists for: warn when it crosses sockets
+            const auto topo = topology();
+            auto package_of = [&topo](int cpu)
+            {
+                for (const auto &c : topo)
+                    if (c.cpu == cpu)
+                        return c.package;
+                return -1;
+            };
+            if (!p.feed.empty() && !p.consumer.empty() &&
+                package_of(p.feed.front()) != package_of(p.consumer.front()))
+                std::cerr << "[CPU] WARNING: feed and consumer are on different sockets — "
+                             "every queue slot crosses the interconnect\n";
+        }
+
+        // "0-3,8,10-11" → {0,1,2,3,8,10,11}
+        static std::vector<int> parse_list(const std::string &text)
+        {
+            std::vector<int> cpus;
+            std::stringstream ss(text);
+            std::string range;
+            while (std::getline(ss, range, ','))
+            {
+                if (range.empty())
+                    continue;
+                const auto dash = range.find('-');
+                const int lo = std::stoi(range.substr(0, dash));
+                const int hi = dash == std::string::npos ? lo : std::stoi(range.substr(dash + 1));
+                if (lo < 0 || hi < lo)
+                    throw std::invalid_argument("bad CPU range '" + range + "'");
+                for (int c = lo; c <= hi; ++c)
+                    cpus.push_back(c);
+            }
+            return cpus;
+        }
+
+        static std::string format_list(const std::vector<int> &cpus)
+        {
+            if (cpus.empty())
+                return "-";
+            std::string out;
+            for (int c : cpus)
+                out += (out.empty() ? "" : ",") + std::to_string(c);
+            return out;
+        }
+
+#if defined(__linux__)
+        static int read_int(const std::string &path, int fallback)
+        {
+            std::ifstream f(path);
+            int v = fallback;
+            if (f && (f >> v))
+                return v;
+            return fallback;
+        }
+
+        // /sys/devices/system/cpu/cpuN/ contains a "nodeK" link on NUMA kernels
+        static int find_node(const std::string &cpu_dir)
+        {
+            for (int node = 0; node < 64; ++node)
+            {
+                std::ifstream probe(cpu_dir + "node" + std::to_string(node) + "/cpulist");
+                if (probe)
+                    return node;
+            }
+            return 0;
+        }
+#endif
+    };
+
+} // namespace MarketStream
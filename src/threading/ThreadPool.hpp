@@ -69,6 +69,7 @@
 #include <iostream>
 #include <iomanip>
 #include <chrono>
+#include "ThreadPlacement.hpp"
 
 namespace MarketStream
 {
@@ -95,13 +96,19 @@ namespace MarketStream
             for (size_t i = 0; i < num_threads; ++i)
             {
                 // std::thread constructor takes a callable.
-                // We pass a member function pointer + 'this' (the pool itself).
+                // The lambda captures 'this' (the pool itself) and the worker index.
                 // Each worker thread runs worker_loop() indefinitely until shutdown.
                 //
                 // WHY emplace_back INSTEAD OF push_back?
                 // emplace_back constructs the thread IN PLACE inside the vector.
                 // push_back would construct it, then move it — one extra operation.
-                workers_.emplace_back(&ThreadPool::worker_loop, this);
+                //
+                // Each worker first places itself (ETL_CPU_PLAN pool CPUs,
+                // worker i → pool CPU i mod N; no-op when unset), then loops.
+                workers_.emplace_back([this, i]()
+                                      {
+                    ThreadPlacement::apply(ThreadRole::Pool, i);
+                    worker_loop(); });
             }
         }
 
@@ -0,0 +1,411 @@
+#pragma once
+
+// ============================================================================
+// PgWireStandIn.hpp — Minimal PostgreSQL wire-protocol server for benchmarks
+// ============================================================================
+//
+// WHY A FAKE SERVER?
+// To measure OUR side of a load (pqxx / libpq / encoding / socket) we need
+// something that speaks the PostgreSQL protocol but costs nothing to ingest.
+// A real server adds parsing, heap inserts and WAL — and needs an install.
+// This stand-in accepts any libpq client (pqxx included), answers every
+// statement with success, and for COPY ... FROM STDIN reads the data, counts
+// rows and bytes, and throws it away.
+//
+// WHAT IT SPEAKS (protocol v3, the subset a COPY load uses):
+//   client                         stand-in
+//   SSLRequest / GSSENCRequest ──► 'N'  (no encryption, plain TCP)
+//   StartupMessage             ──► AuthenticationOk, ParameterStatus × n,
+//                                  BackendKeyData, ReadyForQuery
+//   Query "BEGIN" / DDL / ...  ──► CommandComplete, ReadyForQuery
+//   Query "COPY ... FROM STDIN"──► CopyInResponse
+//   CopyData × n               ──► (counted, discarded)
+//   CopyDone                   ──► CommandComplete "COPY n", ReadyForQuery
+//   Terminate                  ──► connection closed
+// Queries return NO rows (a SELECT completes as "SELECT 0"), so only code
+// paths that never read query results work against it — the COPY paths do.
+// The extended protocol (Parse/Bind/...) is answered with an error.
+//
+// THREADING:
+// One acceptor thread + one thread per connection, all synchronous Boost.Asio
+// (same style as TickServer). ParallelLoader's N COPY connections are served
+// concurrently, so the stand-in never serializes the streams it measures.
+// ============================================================================
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/asio/connect.hpp>
+
+#include <thread>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cctype>
+#include <algorithm>
+#include <iostream>
+
+namespace MarketStream
+{
+
+    class PgWireStandIn
+    {
+        using tcp = boost::asio::ip::tcp;
+
+    public:
+        // port = 0 → the OS picks a free port; read it back with port()
+        explicit PgWireStandIn(uint16_t port = 0) : port_(port) {}
+        ~PgWireStandIn() { stop(); }
+
+        PgWireStandIn(const PgWireStandIn &) = delete;
+        PgWireStandIn &operator=(const PgWireStandIn &) = delete;
+
+        // Bind + listen on 127.0.0.1, then accept on a background thread.
+        // Returns once the port is listening.
+        void start()
+        {
+            auto ready = std::make_shared<std::promise<void>>();
+            auto listening = ready->get_future();
+            running_.store(true, std::memory_order_release);
+            accept_thread_ = std::thread([this, ready]()
+                                         { accept_loop(ready); });
+            listening.get(); // rethrows a bind error
+        }
+
+        void stop()
+        {
+            if (!running_.exchange(false, std::memory_order_acq_rel))
+                return;
+
+            // accept() is blocking: a throwaway connection wakes it up
+            try
+            {
+                boost::asio::io_context ioc;
+                boost::asio::ip::tcp::socket wake(ioc);
+                wake.connect({boost::asio::ip::address_v4::loopback(), port_});
+            }
+            catch (const std::exception &)
+            {
+            }
+            if (accept_thread_.joinable())
+                accept_thread_.join();
+
+            // Sessions block in read() until their client hangs up. shutdown()
+            // (not close(): the fd stays valid for the session still using it)
+            // ends that read with an error, so the join below returns.
+            std::lock_guard<std::mutex> lock(sessions_mutex_);
+            for (auto &s : sockets_)
+            {
+                boost::system::error_code ec;
+                s->shutdown(tcp::socket::shutdown_both, ec);
+            }
+            for (auto &t : sessions_)
+                if (t.joinable())
+                    t.join();
+            sessions_.clear();
+            sockets_.clear();
+        }
+
+        [[nodiscard]] uint16_t port() const { return port_; }
+
+        // libpq connection string for this stand-in
+        [[nodiscard]] std::string conn_str() const
+        {
+            return "host=127.0.0.1 port=" + std::to_string(port_) +
+                   " user=standin dbname=standin sslmode=disable";
+        }
+
+        // Totals over every COPY since start()
+        [[nodiscard]] long long copy_rows() const { return copy_rows_.load(std::memory_order_relaxed); }
+        [[nodiscard]] long long copy_bytes() const { return copy_bytes_.load(std::memory_order_relaxed); }
+        [[nodiscard]] long long copies() const { return copies_.load(std::memory_order_relaxed); }
+
+    private:
+        void accept_loop(std::shared_ptr<std::promise<void>> ready)
+        {
+            tcp::acceptor acceptor(ioc_);
+            try
+            {
+                acceptor.open(tcp::v4());
+                acceptor.set_option(tcp::acceptor::reuse_address(true));
+                acceptor.bind({boost::asio::ip::address_v4::loopback(), port_});
+                acceptor.listen();
+                port_ = acceptor.local_endpoint().port();
+                ready->set_value();
+            }
+            catch (...)
+            {
+                running_.store(false, std::memory_order_release);
+                ready->set_exception(std::current_exception());
+                return;
+            }
+
+            while (running_.load(std::memory_order_acquire))
+            {
+                auto socket = std::make_shared<tcp::socket>(ioc_);
+                boost::system::error_code ec;
+                acceptor.accept(*socket, ec);
+                if (ec || !running_.load(std::memory_order_acquire))
+                    continue;
+
+                socket->set_option(tcp::no_delay(true), ec);
+                std::lock_guard<std::mutex> lock(sessions_mutex_);
+                sockets_.push_back(socket); // stop() shuts it down
+                sessions_.emplace_back([this, socket]()
+                                       { session(*socket); });
+            }
+        }
+
+        // ── Wire helpers ─────────────────────────────────────────────────────
+        // Every backend message: type byte, int32 length (incl. itself), body.
+        static void put_be32(std::string &out, uint32_t v)
+        {
+            out += static_cast<char>(v >> 24);
+            out += static_cast<char>(v >> 16);
+            out += static_cast<char>(v >> 8);
+            out += static_cast<char>(v);
+        }
+
+        static uint32_t get_be32(const unsigned char *p)
+        {
+            return (uint32_t{p[0]} << 24) | (uint32_t{p[1]} << 16) | (uint32_t{p[2]} << 8) | uint32_t{p[3]};
+        }
+
+        static void message(std::string &out, char type, std::string_view body)
+        {
+            out += type;
+            put_be32(out, static_cast<uint32_t>(body.size() + 4));
+            out.append(body);
+        }
+
+        static void ready_for_query(std::string &out, char tx_status)
+        {
+            message(out, 'Z', std::string_view(&tx_status, 1));
+        }
+
+        static void command_complete(std::string &out, const std::string &tag)
+        {
+            message(out, 'C', std::string_view(tag.c_str(), tag.size() + 1));
+        }
+
+        static void error_response(std::string &out, const std::string &text)
+        {
+            std::string body;
+            body += 'S'; body += "ERROR"; body += '\0';
+            body += 'V'; body += "ERROR"; body += '\0';
+            body += 'C'; body += "0A000"; body += '\0'; // feature_not_supported
+            body += 'M'; body += text;    body += '\0';
+            body += '\0';
+            message(out, 'E', body);
+        }
+
+        // ── One client connection ────────────────────────────────────────────
+        void session(tcp::socket &socket)
+        {
+            boost::system::error_code ec;
+            std::vector<unsigned char> body;
+
+            // Reads one frontend message into `body`. Startup packets have no
+            // type byte: pass type == 0 for those, anything else otherwise.
+            auto read_message = [&](char &type) -> bool
+            {
+                unsigned char head[5];
+                const size_t head_len = type == 0 ? 4 : 5;
+                boost::asio::read(socket, boost::asio::buffer(head, head_len), ec);
+                if (ec)
+                    return false;
+                if (head_len == 5)
+                    type = static_cast<char>(head[0]);
+                const uint32_t len = get_be32(head + head_len - 4);
+                if (len < 4)
+                    return false;
+                body.resize(len - 4);
+                boost::asio::read(socket, boost::asio::buffer(body), ec);
+                return !ec;
+            };
+            auto send = [&](const std::string &out)
+            {
+                boost::asio::write(socket, boost::asio::buffer(out), ec);
+                return !ec;
+            };
+
+            // ── Startup: refuse SSL/GSS, accept any user without a password ──
+            for (;;)
+            {
+                char type = 0;
+                if (!read_message(type) || body.size() < 4)
+                    return;
+                const uint32_t code = get_be32(body.data());
+                if (code == 80877103 || code == 80877104) // SSLRequest, GSSENCRequest
+                {
+                    if (!send("N"))
+                        return;
+                    continue;
+                }
+                if (code == 80877102) // CancelRequest — nothing to cancel
+                    return;
+                break; // StartupMessage
+            }
+
+            std::string out;
+            std::string auth_ok;
+            put_be32(auth_ok, 0);
+            message(out, 'R', auth_ok);
+            for (const auto &[key, value] : {std::pair<const char *, const char *>{"server_version", "16.0"},
+                                             {"server_encoding", "UTF8"},
+                                             {"client_encoding", "UTF8"},
+                                             {"DateStyle", "ISO, MDY"},
+                                             {"integer_datetimes", "on"},
+                                             {"standard_conforming_strings", "on"}})
+            {
+                std::string kv = std::string(key) + '\0' + value + '\0';
+                message(out, 'S', kv);
+            }
+            std::string key_data;
+            put_be32(key_data, 1);
+            put_be32(key_data, 1);
+            message(out, 'K', key_data);
+            char tx = 'I';
+            ready_for_query(out, tx);
+            if (!send(out))
+                return;
+
+            // ── Command loop ─────────────────────────────────────────────────
+            bool extended_error = false;
+            for (;;)
+            {
+                char type = 1;
+                if (!read_message(type))
+                    return;
+                out.clear();
+
+                if (type == 'X') // Terminate
+                    return;
+                if (type == 'S') // Sync: end of an extended-protocol batch
+                {
+                    if (extended_error)
+                        error_response(out, "stand-in supports the simple query protocol only");
+                    extended_error = false;
+                    ready_for_query(out, tx);
+                    if (!send(out))
+                        return;
+                    continue;
+                }
+                if (type != 'Q')
+                {
+                    extended_error = true; // Parse / Bind / Execute / ...
+                    continue;
+                }
+
+                std::string sql(body.begin(), body.end());
+                if (!sql.empty() && sql.back() == '\0')
+                    sql.pop_back();
+                std::string upper = sql;
+                std::transform(upper.begin(), upper.end(), upper.begin(),
+                               [](unsigned char c)
+                               { return static_cast<char>(std::toupper(c)); });
+                const size_t word_begin = upper.find_first_not_of(" \t\r\n");
+                if (word_begin == std::string::npos)
+                {
+                    message(out, 'I', {}); // EmptyQueryResponse
+                    ready_for_query(out, tx);
+                    if (!send(out))
+                        return;
+                    continue;
+                }
+                const size_t word_end = upper.find_first_of(" \t\r\n;(", word_begin);
+                const std::string verb = upper.substr(word_begin, word_end - word_begin);
+
+                if (verb == "COPY" && upper.find("FROM STDIN") != std::string::npos)
+                {
+                    if (!copy_in(upper, tx, read_message, send, body))
+                        return;
+                    continue;
+                }
+
+                if (verb == "BEGIN" || verb == "START")
+                    tx = 'T';
+                else if (verb == "COMMIT" || verb == "END" || verb == "ROLLBACK" || verb == "ABORT")
+                    tx = 'I';
+                command_complete(out, verb == "SELECT" ? "SELECT 0" : verb);
+                ready_for_query(out, tx);
+                if (!send(out))
+                    return;
+            }
+        }
+
+        // COPY FROM STDIN: CopyInResponse, then count CopyData until CopyDone
+        template <typename ReadFn, typename SendFn>
+        bool copy_in(const std::string &upper, char tx,
+                     ReadFn &read_message, SendFn &send, std::vector<unsigned char> &body)
+        {
+            // Column count = commas in the first "( ... )" + 1
+            uint16_t columns = 0;
+            const size_t open = upper.find('(');
+            const size_t close = upper.find(')', open);
+            if (open != std::string::npos && close != std::string::npos)
+                columns = static_cast<uint16_t>(std::count(upper.begin() + open, upper.begin() + close, ',') + 1);
+
+            std::string out;
+            std::string response;
+            response += '\0'; // overall format: text
+            response += static_cast<char>(columns >> 8);
+            response += static_cast<char>(columns);
+            response.append(size_t{columns} * 2, '\0'); // every column: text
+            message(out, 'G', response);
+            if (!send(out))
+                return false;
+
+            long long rows = 0;
+            long long bytes = 0;
+            for (;;)
+            {
+                char type = 1;
+                if (!read_message(type))
+                    return false;
+                if (type == 'd') // CopyData
+                {
+                    rows += std::count(body.begin(), body.end(), '\n');
+                    bytes += static_cast<long long>(body.size());
+                    continue;
+                }
+                out.clear();
+                if (type == 'c') // CopyDone
+                {
+                    copy_rows_.fetch_add(rows, std::memory_order_relaxed);
+                    copy_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+                    copies_.fetch_add(1, std::memory_order_relaxed);
+                    command_complete(out, "COPY " + std::to_string(rows));
+                    ready_for_query(out, tx);
+                    return send(out);
+                }
+                if (type == 'f') // CopyFail
+                {
+                    error_response(out, "COPY aborted by client");
+                    ready_for_query(out, tx == 'I' ? 'I' : 'E');
+                    return send(out);
+                }
+                // Flush / Sync inside COPY are ignored, as the real server does
+            }
+        }
+
+        uint16_t port_;
+        std::atomic<bool> running_{false};
+        // Member, not local to accept_loop: session sockets outlive that thread
+        boost::asio::io_context ioc_;
+        std::thread accept_thread_;
+        std::mutex sessions_mutex_;
+        std::vector<std::thread> sessions_;
+        std::vector<std::shared_ptr<tcp::socket>> sockets_;
+
+        std::atomic<long long> copy_rows_{0};
+        std::atomic<long long> copy_bytes_{0};
+        std::atomic<long long> copies_{0};
+    };
+
+} // namespace MarketStream
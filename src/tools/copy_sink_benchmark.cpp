@@ -0,0 +1,276 @@
+// ============================================================================
+// copy_sink_benchmark.cpp — COPY throughput without a PostgreSQL server
+// ============================================================================
+//
+// PURPOSE:
+//   Split the cost of a bulk load into its parts, on any machine:
+//
+//     [1] null sink      — encoding only (the CPU ceiling of one stream)
+//     [2] file sink      — encoding + write(2) of the COPY text
+//     [3] stand-in, libpq blocking      (PgCopySink)
+//     [4] stand-in, pqxx::stream_to     (DatabaseLoader::copy_chunk)
+//     [5] stand-in, async double buffer (DatabaseLoader::copy_chunk_async)
+//
+//   [3]-[5] talk real protocol over a real TCP socket to PgWireStandIn, which
+//   discards the data. Anything they lose against [1] is client + socket
+//   cost; the gap between this tool and a real load is the server.
+//
+//   Every engine runs with 1 stream and with N streams (one thread and one
+//   connection each, exactly like ParallelLoader).
+//
+//     [6] LiveDbSink — ticks offered at a paced LIVE_RATE (250K/s), flushed
+//         in adaptive micro-batches; reports sustained rate and the
+//         offer → commit latency (p99 / max).
+//
+// REGRESSION CHECK:
+//   The stand-in counts every row it receives. If any engine delivers a
+//   different row count than it was given, the tool prints [FAIL] and exits 1.
+//
+// RUN:
+//   ./copy_sink_benchmark [rows=1000000] [streams=4]
+// ============================================================================
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <span>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <functional>
+#include <filesystem>
+#include <cstdlib>
+#include "../database/CopySink.hpp"
+#include "../database/DatabaseLoader.hpp"
+#include "../database/LiveDbSink.hpp"
+#include "PgWireStandIn.hpp"
+
+using MarketStream::CopyStreamStats;
+using MarketStream::Trade;
+
+// Same random walk as TickServer / DataGenerator — realistic field widths
+static std::vector<Trade> make_trades(size_t n)
+{
+    std::mt19937_64 rng(42);
+    std::normal_distribution<double> price_delta(0.0, 0.5);
+    std::uniform_int_distribution<int> vol_dist(10, 5000);
+    std::uniform_int_distribution<int> sym_dist(0, 4);
+    const char *symbols[] = {"RELIANCE", "TCS", "INFY", "HDFC", "WIPRO"};
+    double prices[] = {2456.75, 3567.50, 1423.25, 1678.90, 432.60};
+
+    std::vector<Trade> trades(n);
+    long long ts = 1698208500000000000LL;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const int s = sym_dist(rng);
+        prices[s] = std::max(50.0, prices[s] + price_delta(rng));
+        Trade &t = trades[i];
+        t.trade_id = 5'000'000ULL + i;
+        t.order_id = 9'000'000ULL + i / 3;
+        t.timestamp = (ts += 10'000LL);
+        t.symbol = symbols[s];
+        t.price = prices[s];
+        t.volume = static_cast<uint32_t>(vol_dist(rng));
+        t.side = (i & 1) ? 'B' : 'S';
+        t.type = (i % 10 < 3) ? 'M' : 'L';
+        t.is_pro = (i % 7) == 0;
+    }
+    return trades;
+}
+
+// One stream per thread over contiguous slices; returns {bytes, wall ns, rows}
+using StreamFn = std::function<CopyStreamStats(std::span<const Trade>, int)>;
+
+static CopyStreamStats run_streams(const std::vector<Trade> &trades, int streams, const StreamFn &fn)
+{
+    std::vector<CopyStreamStats> per(streams);
+    std::vector<std::thread> threads;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < streams; ++i)
+    {
+        const size_t begin = trades.size() * i / streams;
+        const size_t end = trades.size() * (i + 1) / streams;
+        threads.emplace_back([&, i, begin, end]()
+                             { per[i] = fn(std::span<const Trade>(trades.data() + begin, end - begin), i); });
+    }
+    for (auto &t : threads)
+        t.join();
+
+    CopyStreamStats total;
+    total.total_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now() - t0)
+                         .count();
+    for (const auto &s : per)
+    {
+        total.rows += s.rows;
+        total.bytes += s.bytes;
+        total.wait_ns += s.wait_ns;
+    }
+    return total;
+}
+
+static void print_header()
+{
+    std::cout << "╔════════════════════════════════╦═════════╦═════════════╦════════════╦══════════╗\n";
+    std::cout << "║ Engine                         ║ Streams ║ Rows        ║ MB/s total ║ Wall ms  ║\n";
+    std::cout << "╠════════════════════════════════╬═════════╬═════════════╬════════════╬══════════╣\n";
+}
+
+static void print_row(const std::string &name, int streams, const CopyStreamStats &s)
+{
+    std::cout << "║ " << std::left << std::setw(30) << name
+              << " ║ " << std::right << std::setw(7) << streams
+              << " ║ " << std::setw(11) << s.rows
+              << " ║ " << std::setw(10) << std::fixed << std::setprecision(1) << s.mb_per_sec()
+              << " ║ " << std::setw(8) << s.total_ns / 1'000'000 << " ║\n";
+}
+
+static void print_footer()
+{
+    std::cout << "╚════════════════════════════════╩═════════╩═════════════╩════════════╩══════════╝\n";
+}
+
+int main(int argc, char **argv)
+{
+    const size_t rows = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    const int streams = argc > 2 ? std::max(1, std::atoi(argv[2])) : 4;
+
+    std::cout << "===================================================\n";
+    std::cout << "   MarketStream ETL | COPY Sink Benchmark\n";
+    std::cout << "===================================================\n\n";
+
+    const std::vector<Trade> trades = make_trades(rows);
+    const long long wire_bytes = MarketStream::CopyRowEncoder::encoded_size(trades);
+    std::cout << "[BENCH] " << rows << " trades, " << wire_bytes / (1024 * 1024)
+              << " MB of COPY text\n";
+
+    MarketStream::PgWireStandIn standin;
+    standin.start();
+    const std::string conn = standin.conn_str();
+    std::cout << "[BENCH] Wire-protocol stand-in on 127.0.0.1:" << standin.port() << "\n\n";
+
+    const std::filesystem::path file_dir = std::filesystem::temp_directory_path();
+
+    struct Engine
+    {
+        std::string name;
+        bool via_standin;
+        StreamFn fn;
+    };
+    const std::vector<Engine> engines = {
+        {"null sink (encode only)", false,
+         [](std::span<const Trade> chunk, int)
+         {
+             MarketStream::NullCopySink sink;
+             return MarketStream::stream_to_sink(sink, chunk);
+         }},
+        {"file sink", false,
+         [&](std::span<const Trade> chunk, int id)
+         {
+             const auto path = file_dir / ("copy_sink_benchmark_" + std::to_string(id) + ".copy");
+             MarketStream::FileCopySink sink(path.string());
+             CopyStreamStats s = MarketStream::stream_to_sink(sink, chunk);
+             std::filesystem::remove(path);
+             return s;
+         }},
+        {"stand-in: libpq blocking", true,
+         [&](std::span<const Trade> chunk, int)
+         {
+             MarketStream::PgCopySink sink(conn);
+             return MarketStream::stream_to_sink(sink, chunk);
+         }},
+        {"stand-in: pqxx stream_to", true,
+         [&](std::span<const Trade> chunk, int id)
+         {
+             MarketStream::DatabaseLoader loader(conn);
+             loader.copy_chunk(chunk, id);
+             CopyStreamStats s;
+             s.rows = static_cast<long long>(chunk.size());
+             s.bytes = MarketStream::CopyRowEncoder::encoded_size(chunk);
+             return s;
+         }},
+        {"stand-in: async double buffer", true,
+         [&](std::span<const Trade> chunk, int id)
+         {
+             MarketStream::DatabaseLoader loader(conn);
+             return loader.copy_chunk_async(chunk, id);
+         }},
+    };
+
+    bool ok = true;
+    print_header();
+    for (const auto &engine : engines)
+    {
+        for (int n : {1, streams})
+        {
+            const long long before = standin.copy_rows();
+            CopyStreamStats s;
+            try
+            {
+                s = run_streams(trades, n, engine.fn);
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << "[FAIL] " << engine.name << ": " << e.what() << "\n";
+                ok = false;
+                continue;
+            }
+            // MB/s over the real COPY text size, whatever the engine reported
+            s.bytes = wire_bytes;
+            print_row(engine.name, n, s);
+
+            const long long delivered = engine.via_standin ? standin.copy_rows() - before : s.rows;
+            if (delivered != static_cast<long long>(rows))
+            {
+                std::cerr << "[FAIL] " << engine.name << " × " << n << ": delivered "
+                          << delivered << " rows, expected " << rows << "\n";
+                ok = false;
+            }
+            if (n == streams)
+                break; // streams == 1: don't run the same case twice
+        }
+    }
+    print_footer();
+
+    // ── [6] Live micro-batch sink at a paced feed rate ────────────────────
+    constexpr long long LIVE_RATE = 250'000; // ticks/sec
+    constexpr long long TICKS_PER_MS = LIVE_RATE / 1000;
+    {
+        const long long before = standin.copy_rows();
+        MarketStream::LiveDbSink sink(conn);
+        sink.start();
+        auto t0 = std::chrono::steady_clock::now();
+        auto next = t0;
+        for (size_t i = 0; i < trades.size(); ++i)
+        {
+            if (i % TICKS_PER_MS == 0)
+            {
+                std::this_thread::sleep_until(next); // 1 ms bursts ≈ a real feed's arrival jitter
+                next += std::chrono::milliseconds(1);
+            }
+            sink.offer(trades[i]);
+        }
+        sink.stop();
+        const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        const MarketStream::LiveSinkStats &live = sink.stats();
+
+        std::cout << "\n[LIVE] LiveDbSink @ " << LIVE_RATE / 1000 << "K ticks/s offered: "
+                  << std::fixed << std::setprecision(0) << static_cast<double>(live.rows) / secs
+                  << " ticks/s committed, " << live.batches << " batches ("
+                  << live.size_flushes << " size / " << live.age_flushes << " age), final batch "
+                  << live.batch_rows << " rows\n";
+        std::cout << "[LIVE] offer → commit latency: p99 " << live.p99_latency_ns / 1'000'000
+                  << " ms, max " << live.max_latency_ns / 1'000'000 << " ms, stalls " << live.stalls << "\n";
+        if (standin.copy_rows() - before != static_cast<long long>(rows) || live.failed_rows != 0)
+        {
+            std::cerr << "[FAIL] LiveDbSink delivered " << standin.copy_rows() - before
+                      << " rows, expected " << rows << "\n";
+            ok = false;
+        }
+    }
+
+    standin.stop();
+    std::cout << (ok ? "\n[BENCH] All engines delivered every row.\n" : "\n[BENCH] FAILED\n");
+    return ok ? 0 : 1;
+}
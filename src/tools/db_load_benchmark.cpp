@@ -0,0 +1,450 @@
+// ============================================================================
+// db_load_benchmark.cpp — Load strategy matrix against a real server
+// ============================================================================
+//
+// PURPOSE:
+//   Pick loader settings from measurements on THIS server, not from one
+//   hand-timed run in a README. The same generated dataset is loaded by
+//   every strategy, each into a fresh copy of the trades schema:
+//
+//     text      COPY ... FROM STDIN (text format)
+//     binary    COPY ... FROM STDIN WITH (FORMAT binary)
+//     insert    INSERT ... VALUES (...), (...)  — 1000 rows per statement
+//     unlogged  text COPY into an UNLOGGED table, then SET LOGGED
+//     freeze    TRUNCATE + COPY ... WITH (FREEZE), one transaction
+//
+//   × streams 1, 2, 4, 8, 16 (one connection + thread each; freeze: 1)
+//   × indexes drop → load into a bare table, then build PK + (symbol, timestamp)
+//             keep → both indexes exist during the load
+//
+//   Timing per case:
+//     load  — first row sent → last stream committed (connects excluded)
+//     post  — SET LOGGED and/or index builds
+//     wall  — load + post: the number to compare
+//   rows/s and MB/s are over wall. MB/s uses the dataset's COPY text size for
+//   every method, so the column compares methods on the same payload.
+//
+// SAFETY: only the table load_bench is created and dropped.
+//
+// RUN:
+//   export ETL_DB_CONN="host=localhost dbname=etl_bench ..."
+//   ./db_load_benchmark [rows=1000000] [max_streams=16] [repeats=1] [json=db_load_benchmark.json]
+//
+//   ETL_BENCH_METHODS=text,binary   restrict the matrix (default: all five)
+//
+//   With repeats > 1 each case reports its median wall time.
+//   Exits 1 if any case failed or loaded the wrong row count.
+// ============================================================================
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <span>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <charconv>
+#include <algorithm>
+#include <memory>
+#include <cstdlib>
+#include <nlohmann/json.hpp>
+#include "../database/CopyStream.hpp"
+
+using MarketStream::CopyBinaryEncoder;
+using MarketStream::CopyRowEncoder;
+using MarketStream::PgCopyStream;
+using MarketStream::Trade;
+
+static constexpr const char *TABLE = "load_bench";
+static constexpr size_t BLOCK_BYTES = 256 * 1024;
+static constexpr size_t INSERT_ROWS_PER_STATEMENT = 1000;
+
+enum class Method
+{
+    Text,
+    Binary,
+    Insert,
+    Unlogged,
+    Freeze
+};
+
+static const char *method_name(Method m)
+{
+    switch (m)
+    {
+    case Method::Text:     return "text";
+    case Method::Binary:   return "binary";
+    case Method::Insert:   return "insert";
+    case Method::Unlogged: return "unlogged";
+    case Method::Freeze:   return "freeze";
+    }
+    return "unknown";
+}
+
+struct Case
+{
+    Method method;
+    int streams;
+    bool keep_indexes;
+};
+
+struct CaseResult
+{
+    Case c;
+    long long load_ns = 0;
+    long long post_ns = 0;
+    long long wall_ns = 0;   // median over repeats
+    long long wire_bytes = 0; // what the streams actually sent
+    std::string error;
+};
+
+// Same random walk as TickServer / DataGenerator — realistic field widths
+static std::vector<Trade> make_trades(size_t n)
+{
+    std::mt19937_64 rng(42);
+    std::normal_distribution<double> price_delta(0.0, 0.5);
+    std::uniform_int_distribution<int> vol_dist(10, 5000);
+    std::uniform_int_distribution<int> sym_dist(0, 4);
+    const char *symbols[] = {"RELIANCE", "TCS", "INFY", "HDFC", "WIPRO"};
+    double prices[] = {2456.75, 3567.50, 1423.25, 1678.90, 432.60};
+
+    std::vector<Trade> trades(n);
+    long long ts = 1698208500000000000LL;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const int s = sym_dist(rng);
+        prices[s] = std::max(50.0, prices[s] + price_delta(rng));
+        Trade &t = trades[i];
+        t.trade_id = 5'000'000ULL + i;
+        t.order_id = 9'000'000ULL + i / 3;
+        t.timestamp = (ts += 10'000LL);
+        t.symbol = symbols[s];
+        t.price = prices[s];
+        t.volume = static_cast<uint32_t>(vol_dist(rng));
+        t.side = (i & 1) ? 'B' : 'S';
+        t.type = (i % 10 < 3) ? 'M' : 'L';
+        t.is_pro = (i % 7) == 0;
+    }
+    return trades;
+}
+
+// ── Schema ───────────────────────────────────────────────────────────────────
+static void create_table(PgCopyStream &admin, bool unlogged, bool with_indexes)
+{
+    admin.exec(std::string("DROP TABLE IF EXISTS ") + TABLE);
+    admin.exec(std::string("CREATE ") + (unlogged ? "UNLOGGED " : "") + "TABLE " + TABLE + R"( (
+        trade_id  BIGINT           NOT NULL,
+        order_id  BIGINT           NOT NULL,
+        timestamp BIGINT           NOT NULL,
+        symbol    VARCHAR(10)      NOT NULL,
+        price     DOUBLE PRECISION NOT NULL CHECK (price > 0),
+        volume    INTEGER          NOT NULL CHECK (volume > 0),
+        side      CHAR(1)          NOT NULL CHECK (side IN ('B','S','N')),
+        type      CHAR(1)          NOT NULL CHECK (type IN ('M','L','I')),
+        is_pro    BOOLEAN          NOT NULL
+    ))");
+    if (with_indexes)
+    {
+        admin.exec(std::string("ALTER TABLE ") + TABLE + " ADD PRIMARY KEY (trade_id)");
+        admin.exec(std::string("CREATE INDEX ") + TABLE + "_symbol_time ON " + TABLE + " (symbol, timestamp)");
+    }
+}
+
+static long long count_rows(PgCopyStream &admin)
+{
+    PGresult *res = PQexec(admin.native(), (std::string("SELECT count(*) FROM ") + TABLE).c_str());
+    long long n = -1;
+    if (PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) == 1)
+        n = std::strtoll(PQgetvalue(res, 0, 0), nullptr, 10);
+    PQclear(res);
+    return n;
+}
+
+// ── One stream: its slice, its connection, one transaction ──────────────────
+static long long load_slice(PgCopyStream &conn, std::span<const Trade> rows, Method method)
+{
+    const std::string columns = std::string(TABLE) + " " + CopyRowEncoder::COLUMNS;
+    long long wire = 0;
+    std::string block;
+    block.reserve(BLOCK_BYTES + 4096);
+
+    conn.exec("BEGIN");
+    if (method == Method::Insert)
+    {
+        // Multi-row VALUES: one parse + plan per 1000 rows instead of per row
+        for (size_t i = 0; i < rows.size(); i += INSERT_ROWS_PER_STATEMENT)
+        {
+            block = "INSERT INTO " + columns + " VALUES ";
+            const size_t end = std::min(rows.size(), i + INSERT_ROWS_PER_STATEMENT);
+            for (size_t r = i; r < end; ++r)
+            {
+                const Trade &t = rows[r];
+                char price[32];
+                *std::to_chars(price, price + sizeof(price) - 1, t.price).ptr = '\0';
+                block += (r == i ? "(" : ",(") + std::to_string(t.trade_id) + "," +
+                         std::to_string(t.order_id) + "," + std::to_string(t.timestamp) + ",'" +
+                         t.symbol + "'," + price + "," + std::to_string(t.volume) + ",'" +
+                         t.side + "','" + t.type + "'," + (t.is_pro ? "true" : "false") + ")";
+            }
+            conn.exec(block);
+            wire += static_cast<long long>(block.size());
+        }
+        conn.exec("COMMIT");
+        return wire;
+    }
+
+    const bool binary = method == Method::Binary;
+    if (method == Method::Freeze)
+        conn.exec(std::string("TRUNCATE ") + TABLE); // FREEZE: table emptied in THIS transaction
+    conn.begin_copy("COPY " + columns + " FROM STDIN" +
+                    (binary ? " WITH (FORMAT binary)" : method == Method::Freeze ? " WITH (FREEZE)" : ""));
+    if (binary)
+        CopyBinaryEncoder::header(block);
+    for (const Trade &t : rows)
+    {
+        if (binary)
+            CopyBinaryEncoder::append(block, t);
+        else
+            CopyRowEncoder::append(block, t);
+        if (block.size() >= BLOCK_BYTES)
+        {
+            conn.put(block);
+            wire += static_cast<long long>(block.size());
+            block.clear();
+        }
+    }
+    if (binary)
+        CopyBinaryEncoder::trailer(block);
+    conn.put(block);
+    wire += static_cast<long long>(block.size());
+    conn.end_copy();
+    conn.exec("COMMIT");
+    return wire;
+}
+
+// ── One case, once ───────────────────────────────────────────────────────────
+static void run_case(const std::string &conn_str, const std::vector<Trade> &trades,
+                     const Case &c, CaseResult &out)
+{
+    using Clock = std::chrono::steady_clock;
+    PgCopyStream admin(conn_str);
+    create_table(admin, c.method == Method::Unlogged, c.keep_indexes);
+
+    // Connect every stream BEFORE the clock starts
+    std::vector<std::unique_ptr<PgCopyStream>> conns;
+    for (int i = 0; i < c.streams; ++i)
+        conns.push_back(std::make_unique<PgCopyStream>(conn_str));
+
+    std::vector<long long> wire(c.streams, 0);
+    std::vector<std::string> errors(c.streams);
+    std::vector<std::thread> threads;
+
+    const auto t0 = Clock::now();
+    for (int i = 0; i < c.streams; ++i)
+    {
+        const size_t begin = trades.size() * i / c.streams;
+        const size_t end = trades.size() * (i + 1) / c.streams;
+        threads.emplace_back([&, i, begin, end]()
+                             {
+            try
+            {
+                wire[i] = load_slice(*conns[i], std::span<const Trade>(trades.data() + begin, end - begin), c.method);
+            }
+            catch (const std::exception &e)
+            {
+                errors[i] = e.what();
+            } });
+    }
+    for (auto &t : threads)
+        t.join();
+    const auto t1 = Clock::now();
+
+    for (const auto &e : errors)
+        if (!e.empty())
+            throw std::runtime_error(e);
+
+    if (c.method == Method::Unlogged)
+        admin.exec(std::string("ALTER TABLE ") + TABLE + " SET LOGGED");
+    if (!c.keep_indexes)
+    {
+        admin.exec(std::string("ALTER TABLE ") + TABLE + " ADD PRIMARY KEY (trade_id)");
+        admin.exec(std::string("CREATE INDEX ") + TABLE + "_symbol_time ON " + TABLE + " (symbol, timestamp)");
+    }
+    const auto t2 = Clock::now();
+
+    const long long loaded = count_rows(admin);
+    if (loaded != static_cast<long long>(trades.size()))
+        throw std::runtime_error("loaded " + std::to_string(loaded) + " rows, expected " +
+                                 std::to_string(trades.size()));
+
+    out.load_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+    out.post_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count();
+    out.wall_ns = out.load_ns + out.post_ns;
+    out.wire_bytes = 0;
+    for (long long w : wire)
+        out.wire_bytes += w;
+}
+
+static std::vector<Method> parse_methods(const char *env)
+{
+    std::vector<Method> all = {Method::Text, Method::Binary, Method::Insert, Method::Unlogged, Method::Freeze};
+    if (!env)
+        return all;
+    std::vector<Method> picked;
+    std::stringstream ss(env);
+    std::string name;
+    while (std::getline(ss, name, ','))
+    {
+        auto it = std::find_if(all.begin(), all.end(), [&](Method m)
+                               { return name == method_name(m); });
+        if (it == all.end())
+            throw std::invalid_argument("Unknown method '" + name + "' (text | binary | insert | unlogged | freeze)");
+        picked.push_back(*it);
+    }
+    return picked;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t rows = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    const int max_streams = argc > 2 ? std::max(1, std::atoi(argv[2])) : 16;
+    const int repeats = argc > 3 ? std::max(1, std::atoi(argv[3])) : 1;
+    const std::string json_path = argc > 4 ? argv[4] : "db_load_benchmark.json";
+
+    const char *env_conn = std::getenv("ETL_DB_CONN");
+    if (!env_conn)
+    {
+        std::cerr << "[ERROR] ETL_DB_CONN environment variable is not set.\n";
+        return 1;
+    }
+
+    std::vector<Method> methods;
+    try
+    {
+        methods = parse_methods(std::getenv("ETL_BENCH_METHODS"));
+    }
+    catch (const std::invalid_argument &e)
+    {
+        std::cerr << "[ERROR] ETL_BENCH_METHODS: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::cout << "===================================================\n";
+    std::cout << "   MarketStream ETL | DB Load Strategy Benchmark\n";
+    std::cout << "===================================================\n\n";
+
+    const std::vector<Trade> trades = make_trades(rows);
+    const long long payload = CopyRowEncoder::encoded_size(trades);
+    std::cout << "[BENCH] " << rows << " trades, " << payload / (1024 * 1024)
+              << " MB of COPY text, table " << TABLE << ", " << repeats << " run(s) per case\n";
+
+    std::vector<Case> cases;
+    for (Method m : methods)
+        for (int streams : {1, 2, 4, 8, 16})
+        {
+            if (streams > max_streams || (m == Method::Freeze && streams > 1))
+                continue;
+            cases.push_back({m, streams, false});
+            cases.push_back({m, streams, true});
+        }
+
+    std::cout << "╔══════════╦═════════╦═════════╦══════════╦══════════╦══════════╦════════════╦═════════╗\n";
+    std::cout << "║ Method   ║ Streams ║ Indexes ║  Load ms ║  Post ms ║  Wall ms ║     rows/s ║    MB/s ║\n";
+    std::cout << "╠══════════╬═════════╬═════════╬══════════╬══════════╬══════════╬════════════╬═════════╣\n";
+
+    std::vector<CaseResult> results;
+    bool ok = true;
+    for (const Case &c : cases)
+    {
+        CaseResult best;
+        best.c = c;
+        std::vector<CaseResult> runs;
+        try
+        {
+            for (int r = 0; r < repeats; ++r)
+            {
+                CaseResult run;
+                run.c = c;
+                run_case(env_conn, trades, c, run);
+                runs.push_back(run);
+            }
+            std::sort(runs.begin(), runs.end(), [](const CaseResult &a, const CaseResult &b)
+                      { return a.wall_ns < b.wall_ns; });
+            best = runs[runs.size() / 2]; // median
+        }
+        catch (const std::exception &e)
+        {
+            best.error = e.what();
+            ok = false;
+        }
+        results.push_back(best);
+
+        std::cout << "║ " << std::left << std::setw(8) << method_name(c.method)
+                  << " ║ " << std::right << std::setw(7) << c.streams
+                  << " ║ " << std::left << std::setw(7) << (c.keep_indexes ? "keep" : "drop") << std::right;
+        if (!best.error.empty())
+        {
+            std::cout << " ║ FAILED — see below                                          ║\n";
+            continue;
+        }
+        const double secs = static_cast<double>(best.wall_ns) / 1e9;
+        std::cout << " ║ " << std::setw(8) << best.load_ns / 1'000'000
+                  << " ║ " << std::setw(8) << best.post_ns / 1'000'000
+                  << " ║ " << std::setw(8) << best.wall_ns / 1'000'000
+                  << " ║ " << std::setw(10) << std::fixed << std::setprecision(0) << static_cast<double>(rows) / secs
+                  << " ║ " << std::setw(7) << std::setprecision(1) << static_cast<double>(payload) / (1024.0 * 1024.0) / secs
+                  << " ║\n";
+    }
+    std::cout << "╚══════════╩═════════╩═════════╩══════════╩══════════╩══════════╩════════════╩═════════╝\n";
+
+    for (const auto &r : results)
+        if (!r.error.empty())
+            std::cerr << "[FAIL] " << method_name(r.c.method) << " × " << r.c.streams
+                      << (r.c.keep_indexes ? " (keep)" : " (drop)") << ": " << r.error << "\n";
+
+    // ── JSON: one object per case, for plotting / diffing between servers ──
+    nlohmann::json out;
+    out["rows"] = rows;
+    out["payload_bytes"] = payload;
+    out["repeats"] = repeats;
+    for (const auto &r : results)
+    {
+        nlohmann::json j;
+        j["method"] = method_name(r.c.method);
+        j["streams"] = r.c.streams;
+        j["indexes"] = r.c.keep_indexes ? "keep" : "drop";
+        if (!r.error.empty())
+        {
+            j["error"] = r.error;
+        }
+        else
+        {
+            const double secs = static_cast<double>(r.wall_ns) / 1e9;
+            j["load_ms"] = static_cast<double>(r.load_ns) / 1e6;
+            j["post_ms"] = static_cast<double>(r.post_ns) / 1e6;
+            j["wall_ms"] = static_cast<double>(r.wall_ns) / 1e6;
+            j["rows_per_sec"] = static_cast<double>(rows) / secs;
+            j["mb_per_sec"] = static_cast<double>(payload) / (1024.0 * 1024.0) / secs;
+            j["wire_bytes"] = r.wire_bytes;
+        }
+        out["results"].push_back(j);
+    }
+    std::ofstream(json_path) << out.dump(2) << "\n";
+    std::cout << "[BENCH] JSON written to " << json_path << "\n";
+
+    // Leave nothing behind
+    try
+    {
+        PgCopyStream admin(env_conn);
+        admin.exec(std::string("DROP TABLE IF EXISTS ") + TABLE);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "[BENCH] Could not drop " << TABLE << ": " << e.what() << "\n";
+    }
+
+    return ok ? 0 : 1;
+}
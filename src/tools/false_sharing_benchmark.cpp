@@ -29,16 +29,37 @@
 //   4 counters on one cache line, 1 counter per thread.
 //   Demonstrates why "just use a small struct" is dangerous in concurrent code.
 //
+//   [EXPERIMENT 4] Separation Sweep — "how far apart is far enough?"
+//   ─────────────────────────────────────────────────────────────────
+//   Experiments 1–3 test ONE separation: CACHE_LINE. Many Intel cores
+//   prefetch the ADJACENT line pair (128-byte "spatial prefetcher"), so two
+//   hot variables 64 bytes apart can still interfere. The sweep moves hot
+//   variables 8, 16, 32, 64, 128, 256 bytes apart and measures throughput,
+//   modelled on our real shared structures:
+//     a) per-thread counters — ThreadPool workers / metrics blocks:
+//        N threads (2 … all cores), each bumps its own counter
+//     b) SPSC indices — SPSCQueue head_ / tail_ at a runtime separation
+//     c) TickClient stats — the client bumps ticks_received_ every tick
+//        while a monitor polls parse_errors_ (TickServer's ticks_sent_ /
+//        running_ pair has the same shape)
+//   The recommended separation = smallest stride within 5% of the best.
+//   Build with -DMARKETSTREAM_CACHE_LINE=<that> to pad SPSCQueue to match.
+//
 // WHAT TO EXPECT:
 //   Experiment 1: Padded ~3-8x faster than unpadded
 //   Experiment 2: Queue with padding ~2-5x faster (queue logic adds noise)
 //   Experiment 3: Performance degrades linearly with contention
+//   Experiment 4: a knee at 64 B — or at 128 B on adjacent-line prefetchers
 //
 // BUILD (add to CMakeLists.txt):
 //   add_executable(false_sharing_benchmark src/tools/false_sharing_benchmark.cpp)
 //
 // RUN:
-//   .\false_sharing_benchmark.exe
+//   .\false_sharing_benchmark.exe                        experiments 1–3
+//   ./false_sharing_benchmark sweep [max_threads=all] [iterations=10000000]
+//                                                         experiment 4 only
+//   The sweep is 6 strides × every team size × 3 layouts — minutes on a
+//   many-core box — so the default run leaves it out.
 // ============================================================================
 
 #include <iostream>
@@ -50,9 +71,19 @@
 #include <numeric>
 #include <algorithm>
 #include <string>
+#include <sstream>
+#include <limits>
+#include <new>     // std::align_val_t, std::launder
+#include <cstring> // std::memset
+#include <cstdlib>
+
+#if defined(__linux__)
+#include <unistd.h> // sysconf(_SC_LEVEL1_DCACHE_LINESIZE)
+#endif
 
 #include "../threading/SPSCQueue.hpp"
 #include "../threading/SPSCQueueNoPadding.hpp"
+#include "../threading/ThreadPlacement.hpp"
 
 // ============================================================================
 // Constants
@@ -366,6 +397,248 @@ static long long bench_4thread_padded(long long n)
         t1.join(); t2.join(); t3.join(); });
 }
 
+// ============================================================================
+// EXPERIMENT 4 — Separation sweep
+// ============================================================================
+// alignas() fixes separation at compile time; the sweep needs it at RUN
+// time. StridedSlots places N atomics `stride` bytes apart in one page-
+// aligned block: slot 0 starts a page, so a 128-byte stride puts every
+// slot at the start of its own adjacent-line pair.
+// ============================================================================
+static constexpr size_t SWEEP_STRIDES[] = {8, 16, 32, 64, 128, 256};
+static constexpr size_t PAGE = 4096;
+
+class StridedSlots
+{
+public:
+    StridedSlots(size_t count, size_t stride)
+        : stride_(stride), bytes_((count * stride + PAGE - 1) / PAGE * PAGE)
+    {
+        mem_ = static_cast<std::byte *>(::operator new(bytes_, std::align_val_t{PAGE}));
+        std::memset(mem_, 0, bytes_);
+        for (size_t i = 0; i < count; ++i)
+            new (mem_ + i * stride_) std::atomic<long long>(0);
+    }
+    ~StridedSlots() { ::operator delete(mem_, std::align_val_t{PAGE}); }
+    StridedSlots(const StridedSlots &) = delete;
+    StridedSlots &operator=(const StridedSlots &) = delete;
+
+    std::atomic<long long> &operator[](size_t i)
+    {
+        return *std::launder(reinterpret_cast<std::atomic<long long> *>(mem_ + i * stride_));
+    }
+
+private:
+    size_t stride_;
+    size_t bytes_;
+    std::byte *mem_;
+};
+
+// Start n threads together (each pinned to its own CPU when there are
+// enough), run body(i) on thread i, return wall time of the slowest.
+template <typename Body>
+static long long run_team(size_t n, Body body)
+{
+    static const auto topo = MarketStream::ThreadPlacement::topology();
+    return measure_ns([&]()
+                      {
+        std::atomic<size_t> ready{0};
+        std::vector<std::thread> team;
+        for (size_t i = 0; i < n; ++i)
+            team.emplace_back([&, i]()
+                              {
+                if (n <= topo.size())
+                    MarketStream::ThreadPlacement::pin_current({topo[i].cpu});
+                ready.fetch_add(1, std::memory_order_acq_rel);
+                while (ready.load(std::memory_order_acquire) < n)
+                    ;
+                body(i); });
+        for (auto &t : team)
+            t.join(); });
+}
+
+// a) Per-thread counters: thread i bumps slot i only
+static long long bench_sweep_counters(size_t threads, size_t stride, long long iters)
+{
+    StridedSlots slots(threads, stride);
+    return run_team(threads, [&](size_t i)
+                    {
+        auto &mine = slots[i];
+        for (long long k = 0; k < iters; ++k)
+            mine.fetch_add(1, std::memory_order_relaxed); });
+}
+
+// b) SPSC indices: SPSCQueue's push/pop protocol, head_ in slot 0 and
+//    tail_ in slot 1 — `stride` bytes apart instead of CACHE_LINE
+static long long bench_sweep_spsc(size_t stride, long long iters)
+{
+    constexpr long long RING = 4096;
+    StridedSlots idx(2, stride);
+    std::vector<long long> ring(RING);
+    auto &head = idx[0];
+    auto &tail = idx[1];
+    return run_team(2, [&](size_t role)
+                    {
+        if (role == 0) // producer
+        {
+            for (long long k = 0; k < iters; ++k)
+            {
+                const long long t = tail.load(std::memory_order_relaxed);
+                while (t - head.load(std::memory_order_acquire) >= RING - 1)
+                    ;
+                ring[static_cast<size_t>(t & (RING - 1))] = k;
+                tail.store(t + 1, std::memory_order_release);
+            }
+        }
+        else // consumer
+        {
+            volatile long long sink = 0;
+            for (long long k = 0; k < iters; ++k)
+            {
+                const long long h = head.load(std::memory_order_relaxed);
+                while (tail.load(std::memory_order_acquire) == h)
+                    ;
+                sink = ring[static_cast<size_t>(h & (RING - 1))];
+                head.store(h + 1, std::memory_order_release);
+            }
+            (void)sink;
+        } });
+}
+
+// c) TickClient stats: slot 0 = ticks_received_ (client RMW per tick),
+//    slot 1 = parse_errors_ (monitor polls). Returns the CLIENT's time.
+static long long bench_sweep_stats(size_t stride, long long iters)
+{
+    StridedSlots slots(2, stride);
+    std::atomic<bool> client_done{false};
+    long long client_ns = std::numeric_limits<long long>::max();
+    run_team(2, [&](size_t role)
+             {
+        if (role == 0)
+        {
+            const auto t0 = Clock::now();
+            auto &ticks = slots[0];
+            for (long long k = 0; k < iters; ++k)
+                ticks.fetch_add(1, std::memory_order_relaxed);
+            const long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count();
+            client_ns = std::min(client_ns, ns);
+            client_done.store(true, std::memory_order_release);
+        }
+        else
+        {
+            volatile long long seen = 0;
+            auto &errors = slots[1];
+            while (!client_done.load(std::memory_order_acquire))
+                seen = errors.load(std::memory_order_relaxed);
+            (void)seen;
+            client_done.store(false, std::memory_order_relaxed); // ready for the next run
+        } });
+    return client_ns;
+}
+
+// Smallest stride whose throughput is within 5% of the best stride
+static size_t knee(const std::vector<double> &mops_per_stride)
+{
+    const double best = *std::max_element(mops_per_stride.begin(), mops_per_stride.end());
+    for (size_t k = 0; k < mops_per_stride.size(); ++k)
+        if (mops_per_stride[k] >= 0.95 * best)
+            return SWEEP_STRIDES[k];
+    return SWEEP_STRIDES[std::size(SWEEP_STRIDES) - 1];
+}
+
+static size_t os_reported_line()
+{
+#if defined(__linux__) && defined(_SC_LEVEL1_DCACHE_LINESIZE)
+    const long line = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+    return line > 0 ? static_cast<size_t>(line) : 0;
+#else
+    return 0;
+#endif
+}
+
+static void run_sweep(size_t max_threads, long long iters)
+{
+    std::cout << "\n[Running Experiment 4: separation sweep, " << iters
+              << " ops per thread, strides 8–256 B, up to " << max_threads << " threads...]\n";
+    if (std::thread::hardware_concurrency() < 2)
+        std::cout << "[WARN] One CPU: threads never run at the same time — no line ever bounces,\n"
+                     "       so the sweep cannot show a knee here.\n";
+
+    // Thread counts: 2, 4, 8, … up to max_threads (always including it)
+    std::vector<size_t> team_sizes;
+    for (size_t t = 2; t < max_threads; t *= 2)
+        team_sizes.push_back(t);
+    team_sizes.push_back(std::max<size_t>(2, max_threads));
+
+    auto mops = [](long long ops, long long ns)
+    { return static_cast<double>(ops) / static_cast<double>(ns) * 1000.0; };
+
+    // ── a) per-thread counters: rows = stride, columns = threads ──────────
+    std::vector<std::vector<double>> counters(team_sizes.size());
+    for (size_t t = 0; t < team_sizes.size(); ++t)
+        for (size_t stride : SWEEP_STRIDES)
+            counters[t].push_back(mops(iters * static_cast<long long>(team_sizes[t]),
+                                       bench_sweep_counters(team_sizes[t], stride, iters)));
+
+    std::cout << "\n4a) Per-thread counters (ThreadPool workers / metrics) — total M ops/s\n";
+    std::cout << "  stride ";
+    for (size_t n : team_sizes)
+        std::cout << std::setw(9) << n << "T";
+    std::cout << "\n";
+    for (size_t k = 0; k < std::size(SWEEP_STRIDES); ++k)
+    {
+        std::cout << "  " << std::setw(4) << SWEEP_STRIDES[k] << " B ";
+        for (size_t t = 0; t < team_sizes.size(); ++t)
+            std::cout << std::setw(10) << std::fixed << std::setprecision(1) << counters[t][k];
+        std::cout << "\n";
+    }
+
+    // ── b) + c) two-thread models ─────────────────────────────────────────
+    std::vector<double> spsc, stats;
+    for (size_t stride : SWEEP_STRIDES)
+    {
+        spsc.push_back(mops(iters, bench_sweep_spsc(stride, iters)));
+        stats.push_back(mops(iters, bench_sweep_stats(stride, iters)));
+    }
+    std::cout << "\n4b) SPSC head_/tail_ and 4c) TickClient stats (client side) — M ops/s\n";
+    std::cout << "  stride      SPSC     stats\n";
+    for (size_t k = 0; k < std::size(SWEEP_STRIDES); ++k)
+        std::cout << "  " << std::setw(4) << SWEEP_STRIDES[k] << " B "
+                  << std::setw(9) << std::setprecision(1) << spsc[k]
+                  << std::setw(10) << stats[k] << "\n";
+
+    // ── Recommendation ────────────────────────────────────────────────────
+    const size_t knee_counters = knee(counters.back());
+    const size_t knee_spsc = knee(spsc);
+    const size_t knee_stats = knee(stats);
+    const size_t recommended = std::max({knee_counters, knee_spsc, knee_stats});
+    const size_t os_line = os_reported_line();
+
+    std::cout << "\n";
+    std::cout << "╔══════════════════════════════════════════════════════════════════════╗\n";
+    std::cout << "║  Experiment 4: Separation needed on this host (within 5% of best)    ║\n";
+    std::cout << "╠══════════════════════════════════════════════════════════════════════╣\n";
+    auto line = [](const std::string &label, const std::string &value)
+    {
+        std::cout << "║  " << std::left << std::setw(40) << label << std::setw(28) << value
+                  << std::right << "║\n";
+    };
+    line("Per-thread counters (" + std::to_string(team_sizes.back()) + " threads)",
+         std::to_string(knee_counters) + " B");
+    line("SPSC head_ / tail_", std::to_string(knee_spsc) + " B");
+    line("TickClient stats", std::to_string(knee_stats) + " B");
+    line("Recommended interference size", std::to_string(recommended) + " B");
+    line("Compiled CACHE_LINE (SPSCQueue padding)", std::to_string(CACHE_LINE) + " B");
+    line("OS-reported L1 line", os_line ? std::to_string(os_line) + " B" : std::string("unknown"));
+    std::cout << "╚══════════════════════════════════════════════════════════════════════╝\n";
+
+    if (recommended > CACHE_LINE)
+        std::cout << "  → Padding is too small for this host. Rebuild with:\n"
+                  << "      cmake .. -DMARKETSTREAM_CACHE_LINE=" << recommended << "\n";
+    else
+        std::cout << "  → CACHE_LINE = " << CACHE_LINE << " B is enough on this host.\n";
+}
+
 // ============================================================================
 // Memory layout verification
 // ============================================================================
@@ -415,12 +688,28 @@ static void print_memory_verification()
 // ============================================================================
 // main()
 // ============================================================================
-int main()
+int main(int argc, char **argv)
 {
     std::cout << "===================================================\n";
     std::cout << "   MarketStream ETL | Phase 12: False Sharing Demo\n";
     std::cout << "===================================================\n\n";
 
+    const std::string mode = argc > 1 ? argv[1] : "";
+    const size_t max_threads = argc > 2 && std::string(argv[2]) != "all"
+                                   ? static_cast<size_t>(std::max(2, std::atoi(argv[2])))
+                                   : std::max<size_t>(2, std::thread::hardware_concurrency());
+    const long long sweep_iters = argc > 3 ? std::max(1LL, std::atoll(argv[3])) : 10'000'000LL;
+    if (mode == "sweep")
+    {
+        run_sweep(max_threads, sweep_iters);
+        return 0;
+    }
+    if (!mode.empty())
+    {
+        std::cerr << "Usage: false_sharing_benchmark [sweep [max_threads|all] [iterations]]\n";
+        return 1;
+    }
+
     // ── Memory Layout Proof ────────────────────────────────────────────────
     print_memory_verification();
 
@@ -507,5 +796,7 @@ int main()
     std::cout << " The fix: alignas(64) + padding. One cache line per hot variable.\n";
     std::cout << " This is exactly how our SPSC ring buffer is designed.\"\n";
 
+    std::cout << "\nSeparation sweep (Experiment 4): false_sharing_benchmark sweep [max_threads|all] [iterations]\n";
+
     return 0;
 }
\ No newline at end of file
@@ -17,12 +17,29 @@
 //     - Per-operation latency in nanoseconds
 //     - Throughput in millions of operations per second
 //
+//   Throughput alone hides the number the live feed cares about: how long
+//   ONE tick takes to cross from the TickClient core to the consumer core.
+//   Two more modes measure exactly that:
+//
+//   pingpong — two threads bounce a counter through a pair of SPSCQueues.
+//              Every round trip is timed individually → percentiles + a
+//              log2 latency histogram, not just an average.
+//   matrix   — the same ping-pong with the two threads pinned to every CPU
+//              pair (ThreadPlacement::pin_current). Prints a core-to-core
+//              median round-trip matrix, the fastest pairs, and the
+//              ETL_CPU_PLAN line that puts feed + consumer on the best pair.
+//
 // HOW TO BUILD (add to CMakeLists.txt):
 //   add_executable(spsc_benchmark src/tools/spsc_benchmark.cpp)
 //   # No extra libraries — pure C++20 standard library
 //
 // HOW TO RUN:
-//   .\spsc_benchmark.exe
+//   .\spsc_benchmark.exe                                   throughput + unpinned ping-pong
+//   ./spsc_benchmark pingpong [rounds=1000000] [cpu_a cpu_b]
+//   ./spsc_benchmark matrix [rounds=20000] [cpus=all] [csv=spsc_core_matrix.csv]
+//     cpus  list like 0-7,16-23 (default: every online CPU)
+//
+//   Round trip = A→B + B→A. One-way hand-off ≈ RTT / 2.
 // ============================================================================
 
 #include <iostream>
@@ -36,7 +53,11 @@
 #include <algorithm>
 #include <numeric>
 #include <condition_variable>
+#include <fstream>
+#include <sstream>
+#include <string>
 #include "../threading/SPSCQueue.hpp"
+#include "../threading/ThreadPlacement.hpp"
 
 // ============================================================================
 // MutexQueue — The baseline: std::queue + std::mutex
@@ -289,6 +310,325 @@ static long long bench_spsc_spin(long long n_ops)
     return elapsed_ns(t_start, t_end);
 }
 
+// ============================================================================
+// BENCHMARK 4: Ping-pong round trip (per-operation latency)
+// ============================================================================
+// Two queues, two threads, ONE message in flight:
+//
+//   initiator: t0 = now(); ping.push(i); spin until pong.pop(); rtt = now() - t0
+//   responder: spin until ping.pop(); pong.push(i)
+//
+// Bulk throughput lets the producer run thousands of slots ahead, so cache
+// lines move in batches. Here each round trip pays the full cost twice: the
+// ping slot + tail_ line moving A→B, then the pong slot + tail_ line B→A.
+// That IS the live feed's situation — one tick arrives, one tick is handed off.
+//
+// cpu_a / cpu_b: pin the initiator / responder (-1 = let the scheduler pick).
+// Returns the sorted round-trip samples in ns, or empty if a pin failed.
+// ============================================================================
+static std::vector<uint32_t> bench_ping_pong(long long rounds, int cpu_a, int cpu_b)
+{
+    MarketStream::SPSCQueue<uint64_t, 64> ping;
+    MarketStream::SPSCQueue<uint64_t, 64> pong;
+    constexpr long long WARMUP = 1'000; // first rounds fault in pages + ramp clocks
+
+    std::vector<uint32_t> samples(static_cast<size_t>(rounds));
+    std::atomic<int> pinned{0};
+    std::atomic<bool> pin_failed{false};
+
+    auto pin = [&](int cpu)
+    {
+        if (cpu >= 0 && !MarketStream::ThreadPlacement::pin_current({cpu}))
+            pin_failed.store(true, std::memory_order_relaxed);
+        pinned.fetch_add(1, std::memory_order_acq_rel);
+        // Start together: neither side measures the other's thread start-up
+        while (pinned.load(std::memory_order_acquire) < 2)
+            ;
+    };
+
+    std::thread responder([&]()
+                          {
+        pin(cpu_b);
+        if (pin_failed.load(std::memory_order_relaxed))
+            return;
+        for (long long i = 0; i < rounds + WARMUP; ++i)
+        {
+            std::optional<uint64_t> item;
+            while (!(item = ping.try_pop()))
+                ;
+            while (!pong.try_push(*item))
+                ;
+        } });
+
+    std::thread initiator([&]()
+                          {
+        pin(cpu_a);
+        if (pin_failed.load(std::memory_order_relaxed))
+            return;
+        for (long long i = 0; i < rounds + WARMUP; ++i)
+        {
+            const auto t0 = Clock::now();
+            while (!ping.try_push(static_cast<uint64_t>(i)))
+                ;
+            while (!pong.try_pop())
+                ;
+            const auto t1 = Clock::now();
+            if (i >= WARMUP)
+            {
+                const long long ns = elapsed_ns(t0, t1);
+                samples[static_cast<size_t>(i - WARMUP)] =
+                    static_cast<uint32_t>(std::min<long long>(ns, UINT32_MAX));
+            }
+        } });
+
+    initiator.join();
+    responder.join();
+    if (pin_failed.load())
+        return {};
+    std::sort(samples.begin(), samples.end());
+    return samples;
+}
+
+static uint32_t percentile(const std::vector<uint32_t> &sorted, double p)
+{
+    const size_t idx = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1));
+    return sorted[idx];
+}
+
+// ============================================================================
+// print_histogram() — percentiles + log2 buckets of round-trip times
+// ============================================================================
+// WHY LOG2 BUCKETS?
+// The body sits at ~100 ns; the tail (an interrupt, a context switch, an SMI)
+// reaches tens of microseconds. Linear buckets would put everything in the
+// first bar. Doubling buckets show both in ~10 lines.
+// ============================================================================
+static void print_histogram(const std::vector<uint32_t> &sorted)
+{
+    const double mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) /
+                        static_cast<double>(sorted.size());
+
+    std::cout << "╔═══════════════════════════════════════════════════════╗\n";
+    std::cout << "║   Ping-Pong Round Trip — " << std::left << std::setw(10) << sorted.size()
+              << " samples           ║\n" << std::right;
+    std::cout << "╠═══════════════════════════════════════════════════════╣\n";
+    auto row = [](const char *label, double ns)
+    {
+        std::cout << "║  " << std::left << std::setw(10) << label << std::right
+                  << std::fixed << std::setprecision(0) << std::setw(10) << ns
+                  << " ns   (one-way ≈ " << std::setw(8) << ns / 2.0 << " ns)    ║\n";
+    };
+    row("min", sorted.front());
+    row("mean", mean);
+    row("p50", percentile(sorted, 0.50));
+    row("p90", percentile(sorted, 0.90));
+    row("p99", percentile(sorted, 0.99));
+    row("p99.9", percentile(sorted, 0.999));
+    row("max", sorted.back());
+    std::cout << "╠═══════════════════════════════════════════════════════╣\n";
+
+    // Bucket b holds [2^b, 2^(b+1)) ns
+    std::vector<size_t> buckets(33, 0);
+    for (uint32_t ns : sorted)
+    {
+        int b = 0;
+        while (b < 32 && (uint64_t{1} << (b + 1)) <= ns)
+            ++b;
+        ++buckets[static_cast<size_t>(b)];
+    }
+    constexpr int BAR_WIDTH = 24;
+    for (size_t b = 0; b < buckets.size(); ++b)
+    {
+        if (buckets[b] == 0)
+            continue;
+        const double share = static_cast<double>(buckets[b]) / static_cast<double>(sorted.size());
+        const int bar = std::max(share > 0.0 ? 1 : 0, static_cast<int>(share * BAR_WIDTH + 0.5));
+        std::string bars;
+        for (int i = 0; i < bar; ++i)
+            bars += "█";
+        std::cout << "║ " << std::setw(7) << (uint64_t{1} << b) << "-" << std::left << std::setw(8)
+                  << ((uint64_t{1} << (b + 1)) - 1) << std::right << " ns " << bars
+                  << std::string(static_cast<size_t>(BAR_WIDTH - bar), ' ')
+                  << std::fixed << std::setprecision(2) << std::setw(7) << share * 100.0 << "%  ║\n";
+    }
+    std::cout << "╚═══════════════════════════════════════════════════════╝\n";
+}
+
+// ============================================================================
+// run_pingpong() — `spsc_benchmark pingpong [rounds] [cpu_a cpu_b]`
+// ============================================================================
+static int run_pingpong(long long rounds, int cpu_a, int cpu_b)
+{
+    std::cout << "Ping-pong: " << rounds << " round trips, initiator on "
+              << (cpu_a < 0 ? std::string("any CPU") : "CPU " + std::to_string(cpu_a))
+              << ", responder on "
+              << (cpu_b < 0 ? std::string("any CPU") : "CPU " + std::to_string(cpu_b)) << "\n\n";
+
+    if (std::thread::hardware_concurrency() < 2)
+        std::cerr << "[WARN] One CPU: both spinners share it — round trips measure scheduler time slices.\n";
+
+    const auto samples = bench_ping_pong(rounds, cpu_a, cpu_b);
+    if (samples.empty())
+    {
+        std::cerr << "[ERROR] Could not pin to the requested CPUs.\n";
+        return 1;
+    }
+    print_histogram(samples);
+    return 0;
+}
+
+// ============================================================================
+// run_matrix() — `spsc_benchmark matrix [rounds] [cpus] [csv]`
+// ============================================================================
+// Every unordered CPU pair once (A→B and B→A are the same two cache-line
+// transfers; the matrix is mirrored). Cell = median round trip in ns.
+// Typical shape on a dual-socket box:
+//   SMT siblings      ~20–60 ns   (shared L1/L2)
+//   same socket       ~80–200 ns  (through L3)
+//   across sockets    ~250–600 ns (interconnect)
+// The fastest pairs NOT on one physical core are the feed/consumer candidates
+// (an SMT pair shares execution units — see ThreadPlacement 'auto;smt').
+// ============================================================================
+static int run_matrix(long long rounds, const std::vector<int> &cpus, const std::string &csv_path)
+{
+    const auto topo = MarketStream::ThreadPlacement::topology();
+    auto info = [&topo](int cpu)
+    {
+        for (const auto &c : topo)
+            if (c.cpu == cpu)
+                return c;
+        return MarketStream::CpuInfo{cpu, -1, -1, -1};
+    };
+
+    const size_t n = cpus.size();
+    if (n < 2)
+    {
+        std::cerr << "[ERROR] Need at least two CPUs for a core-to-core matrix.\n";
+        return 1;
+    }
+    std::cout << "Core-to-core matrix: " << n << " CPUs, " << n * (n - 1) / 2
+              << " pairs × " << rounds << " round trips\n";
+
+    // 0 = not measured (diagonal, or a pin failed)
+    std::vector<std::vector<uint32_t>> median(n, std::vector<uint32_t>(n, 0));
+    struct Pair
+    {
+        int a, b;
+        uint32_t p50, p99;
+    };
+    std::vector<Pair> pairs;
+    for (size_t i = 0; i < n; ++i)
+    {
+        for (size_t j = i + 1; j < n; ++j)
+        {
+            const auto samples = bench_ping_pong(rounds, cpus[i], cpus[j]);
+            if (samples.empty())
+                continue;
+            median[i][j] = median[j][i] = percentile(samples, 0.50);
+            pairs.push_back({cpus[i], cpus[j], median[i][j], percentile(samples, 0.99)});
+        }
+        std::cout << "  [" << i + 1 << "/" << n << "] CPU " << cpus[i] << " done\r" << std::flush;
+    }
+    std::cout << "\n\n";
+
+    // ── Matrix (median RTT, ns) ────────────────────────────────────────────
+    std::cout << "Median round trip (ns) — row = initiator CPU, column = responder CPU\n";
+    std::cout << "      ";
+    for (int c : cpus)
+        std::cout << ' ' << std::setw(7) << c;
+    std::cout << "\n";
+    for (size_t i = 0; i < n; ++i)
+    {
+        std::cout << std::setw(5) << cpus[i] << " ";
+        for (size_t j = 0; j < n; ++j)
+        {
+            if (median[i][j] == 0)
+                std::cout << ' ' << std::setw(7) << "-";
+            else
+                std::cout << ' ' << std::setw(7) << median[i][j];
+        }
+        std::cout << "\n";
+    }
+    std::cout << "\n";
+
+    if (pairs.empty())
+    {
+        std::cerr << "[ERROR] No CPU pair could be measured.\n";
+        return 1;
+    }
+
+    // ── Ranking: fastest pairs, SMT siblings marked ───────────────────────
+    std::sort(pairs.begin(), pairs.end(), [](const Pair &x, const Pair &y)
+              { return x.p50 != y.p50 ? x.p50 < y.p50 : x.p99 < y.p99; });
+    auto same_core = [&info](int a, int b)
+    {
+        const auto ia = info(a), ib = info(b);
+        return ia.package == ib.package && ia.core == ib.core && ia.core >= 0;
+    };
+
+    std::cout << "╔══════════════╦═══════════╦═══════════╦══════════════════════╗\n";
+    std::cout << "║ CPU pair     ║  p50 (ns) ║  p99 (ns) ║ Topology             ║\n";
+    std::cout << "╠══════════════╬═══════════╬═══════════╬══════════════════════╣\n";
+    for (size_t k = 0; k < std::min<size_t>(pairs.size(), 10); ++k)
+    {
+        const Pair &p = pairs[k];
+        const auto ia = info(p.a), ib = info(p.b);
+        const std::string where = same_core(p.a, p.b)      ? "SMT siblings"
+                                  : ia.package == ib.package ? "socket " + std::to_string(ia.package)
+                                                             : "cross-socket";
+        std::cout << "║ " << std::setw(5) << p.a << " ↔ " << std::left << std::setw(4) << p.b << std::right
+                  << " ║ " << std::setw(9) << p.p50
+                  << " ║ " << std::setw(9) << p.p99
+                  << " ║ " << std::left << std::setw(20) << where << std::right << " ║\n";
+    }
+    std::cout << "╚══════════════╩═══════════╩═══════════╩══════════════════════╝\n\n";
+
+    // ── Placement suggestion: fastest pair on two different physical cores ─
+    auto best = std::find_if(pairs.begin(), pairs.end(), [&](const Pair &p)
+                             { return !same_core(p.a, p.b); });
+    if (best == pairs.end())
+        best = pairs.begin();
+    std::cout << "Suggested placement for the feed → consumer hand-off:\n";
+    std::cout << "  ETL_CPU_PLAN='feed=" << best->a << ";consumer=" << best->b << "'"
+              << "   (p50 " << best->p50 << " ns round trip)\n";
+    if (same_core(pairs.front().a, pairs.front().b) && best != pairs.begin())
+        std::cout << "  Fastest overall is the SMT pair " << pairs.front().a << "/" << pairs.front().b
+                  << " (" << pairs.front().p50 << " ns) — use it only if nothing else runs on that core.\n";
+
+    // ── CSV for plotting / diffing between boxes ───────────────────────────
+    std::ofstream csv(csv_path);
+    csv << "cpu_a,cpu_b,package_a,package_b,core_a,core_b,p50_ns,p99_ns\n";
+    for (const Pair &p : pairs)
+    {
+        const auto ia = info(p.a), ib = info(p.b);
+        csv << p.a << ',' << p.b << ',' << ia.package << ',' << ib.package << ','
+            << ia.core << ',' << ib.core << ',' << p.p50 << ',' << p.p99 << '\n';
+    }
+    std::cout << "\nMatrix written to " << csv_path << "\n";
+    return 0;
+}
+
+// "0-3,8" → {0,1,2,3,8}
+static std::vector<int> parse_cpu_list(const std::string &text)
+{
+    std::vector<int> cpus;
+    std::stringstream ss(text);
+    std::string range;
+    while (std::getline(ss, range, ','))
+    {
+        if (range.empty())
+            continue;
+        const auto dash = range.find('-');
+        const int lo = std::stoi(range.substr(0, dash));
+        const int hi = dash == std::string::npos ? lo : std::stoi(range.substr(dash + 1));
+        for (int c = lo; c <= hi; ++c)
+            cpus.push_back(c);
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
 // ============================================================================
 // BONUS: Queue Size Demo
 // ============================================================================
@@ -342,12 +682,38 @@ static void print_memory_layout()
 // ============================================================================
 // main()
 // ============================================================================
-int main()
+int main(int argc, char **argv)
 {
     std::cout << "===================================================\n";
     std::cout << "   MarketStream ETL | Phase 11: SPSC Benchmark\n";
     std::cout << "===================================================\n\n";
 
+    const std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "pingpong")
+    {
+        const long long rounds = argc > 2 ? std::max(1LL, std::atoll(argv[2])) : 1'000'000;
+        const int cpu_a = argc > 3 ? std::atoi(argv[3]) : -1;
+        const int cpu_b = argc > 4 ? std::atoi(argv[4]) : -1;
+        return run_pingpong(rounds, cpu_a, cpu_b);
+    }
+    if (mode == "matrix")
+    {
+        const long long rounds = argc > 2 ? std::max(1LL, std::atoll(argv[2])) : 20'000;
+        std::vector<int> cpus;
+        if (argc > 3 && std::string(argv[3]) != "all")
+            cpus = parse_cpu_list(argv[3]);
+        else
+            for (const auto &c : MarketStream::ThreadPlacement::topology())
+                cpus.push_back(c.cpu);
+        const std::string csv = argc > 4 ? argv[4] : "spsc_core_matrix.csv";
+        return run_matrix(rounds, cpus, csv);
+    }
+    if (!mode.empty())
+    {
+        std::cerr << "Usage: spsc_benchmark [pingpong [rounds] [cpu_a cpu_b] | matrix [rounds] [cpus] [csv]]\n";
+        return 1;
+    }
+
     // Show memory layout first
     print_memory_layout();
 
@@ -414,6 +780,15 @@ int main()
               << "║\n";
     std::cout << "╚════════════════════════════════════════════════════════════╝\n\n";
 
+    // ── Single-message latency (what one live tick sees) ───────────────────
+    // Two spinners on one CPU only hand over at time-slice ends — skip there.
+    if (std::thread::hardware_concurrency() >= 2)
+    {
+        std::cout << "Ping-pong (unpinned) — pin with: spsc_benchmark pingpong <rounds> <cpu_a> <cpu_b>\n";
+        print_histogram(bench_ping_pong(200'000, -1, -1));
+        std::cout << "\n";
+    }
+
     // ── Interview Talking Points ───────────────────────────────────────────
     std::cout << "INTERVIEW TALKING POINTS:\n";
     std::cout << "─────────────────────────\n";
@@ -16,12 +16,49 @@
 //   Thread 2 (client_thread inside TickClient):
 //     Receives JSON frames from WebSocket
 //     Parses JSON → TickMessage → Trade
+//     Journals the Trade (only when ETL_JOURNAL_DIR is set)
 //     Pushes Trade into SPSCQueue<Trade, 4096>
 //
-//   Thread 3 (consumer thread in main):
+//   Thread 3 (consumer thread in main — or N shard threads, see SHARDING):
 //     Pops Trade from SPSCQueue
 //     Validates: price > 0, volume > 0 (lightweight hot-path check)
+//     Restores per-symbol timestamp order within a 50ms lateness budget (TickReorderBuffer)
+//     Screens each price against per-symbol EWMA statistics (OutlierFilter)
 //     Counts by symbol (in-memory stats)
+//     Aggregates buy/sell and pro/retail volume per 1-second bucket (OrderFlowAccumulator)
+//     Updates monitoring sketches: percentiles, distinct orders, top symbols
+//     Forwards accepted ticks to LiveDbSink (only when ETL_DB_CONN is set)
+//
+//   Thread 4 (LiveDbSink, optional — one per consumer shard):
+//     Micro-batches ticks into COPY trades_live on one persistent connection
+//     Flush at batch size (adaptive) or 50 ms age — see LiveDbSink.hpp
+//
+//   Threads 5+6 (RollingParquetSink, optional — ETL_LIVE_PARQUET_DIR set;
+//                one pair per consumer shard, files trades_live_s<i>_*):
+//     Collector fills Arrow column builders; writer compresses row groups
+//     and rotates trades_live_*.parquet files — see RollingParquetSink.hpp
+//
+//   Thread 7 (TickJournal, optional — ETL_JOURNAL_DIR set):
+//     The client copies every received tick into memory-mapped journal
+//     segments before queueing it; this thread preallocates segments and
+//     msyncs them.
+//     Segments left by a crashed run are replayed through the consumer
+//     before live ticks; a clean shutdown deletes them — see TickJournal.hpp
+//
+// PLACEMENT (ETL_CPU_PLAN set — see ThreadPlacement.hpp):
+//   Server, client and consumer pin themselves to their planned cores;
+//   'auto' keeps client and consumer on one socket. Sink and journal threads
+//   move to the helper set (every core but those three) as they start —
+//   they are created by the pinned consumer and would otherwise inherit its
+//   single core. Unset = scheduler decides.
+//
+// SHARDING (ETL_SHARDS=N, default 1):
+//   The client routes each tick by symbol hash to one of N queues; each queue
+//   has its own consumer thread with its own reorder buffer, outlier filter,
+//   order flow, sketches and sinks. A symbol lives on exactly one shard, so
+//   per-symbol order is preserved and no consumer state is shared or locked.
+//   Results are merged after the run (sketches via MarketSketches::merge).
+//   One slow shard backpressures the whole feed — see TickClient.hpp.
 //
 // THREAD INTERACTION:
 //
@@ -33,6 +70,11 @@
 //        │                   (SPSCQueue)              │
 //       ...                       │                  ...
 //
+// SHUTDOWN ORDER:
+// A timer stops the SERVER and CLIENT first; consumers keep popping until the
+// client has exited AND their queue is empty. Every journaled tick is then
+// consumed before the journal is judged redundant and deleted.
+//
 // BACKPRESSURE:
 // If consumer is slow → SPSCQueue fills up → client's try_push() yields.
 // Client stays blocked until consumer catches up. No data loss.
@@ -47,10 +89,23 @@
 #include <unordered_map>
 #include <string>
 #include <optional>
+#include <vector>
+#include <memory>
+#include <cstdlib>
+#include <algorithm>
+#include <limits>
 
 #include "../feed/TickServer.hpp"
 #include "../feed/TickClient.hpp"
+#include "../feed/TickReorderBuffer.hpp"
+#include "../feed/TickJournal.hpp"
 #include "../threading/SPSCQueue.hpp"
+#include "../threading/ThreadPlacement.hpp"
+#include "../validator/OutlierFilter.hpp"
+#include "../indicators/OrderFlow.hpp"
+#include "../indicators/Sketches.hpp"
+#include "../database/LiveDbSink.hpp"
+#include "../output/RollingParquetSink.hpp"
 #include "../model/Trade.hpp"
 
 using namespace MarketStream;
@@ -64,6 +119,8 @@ using TradeQueue = SPSCQueue<Trade, 4096>;
 // Producer = client thread.
 // Consumer = the thread calling try_pop(). Here that's main.
 // Using any other thread as consumer would break the SPSC contract.
+// Sharded (ETL_SHARDS > 1): N queues, so N consumers — one thread per queue,
+// each running this same loop over the symbols its queue receives.
 //
 // WHAT THE CONSUMER DOES:
 // For this demo: lightweight validation + per-symbol counting.
@@ -75,19 +132,162 @@ struct ConsumerStats
     size_t total_consumed = 0;
     size_t valid          = 0;
     size_t rejected       = 0;
+    size_t outliers       = 0;   // Passed the sanity check, failed the k-sigma screen
+    OutlierStats outlier_stats;
+    ReorderStats reorder_stats;
     std::unordered_map<std::string, size_t> per_symbol;
+    std::vector<OrderFlowBucket> order_flow;   // Closed buckets, streaming mode
+    MarketSketchSnapshot sketches;
+    JournalReplayStats recovery;   // Ticks replayed from a crashed run's journal
+    size_t recovery_skipped = 0;   // ...of those, already committed to trades_live
 };
 
+// Shard results → one report. Symbols never span shards, so per_symbol
+// entries are disjoint; recovery is the same journal read by every shard.
+static void merge_into(ConsumerStats& into, ConsumerStats&& from)
+{
+    into.total_consumed += from.total_consumed;
+    into.valid          += from.valid;
+    into.rejected       += from.rejected;
+    into.outliers       += from.outliers;
+    into.recovery_skipped += from.recovery_skipped;
+    into.outlier_stats.accepted  += from.outlier_stats.accepted;
+    into.outlier_stats.warmup    += from.outlier_stats.warmup;
+    into.outlier_stats.reseeded  += from.outlier_stats.reseeded;
+    into.outlier_stats.rejected  += from.outlier_stats.rejected;
+    into.outlier_stats.untracked += from.outlier_stats.untracked;
+    into.reorder_stats.received       += from.reorder_stats.received;
+    into.reorder_stats.released       += from.reorder_stats.released;
+    into.reorder_stats.reordered      += from.reorder_stats.reordered;
+    into.reorder_stats.late           += from.reorder_stats.late;
+    into.reorder_stats.force_released += from.reorder_stats.force_released;
+    into.reorder_stats.max_depth = std::max(into.reorder_stats.max_depth, from.reorder_stats.max_depth);
+    into.per_symbol.merge(from.per_symbol);
+    into.order_flow.insert(into.order_flow.end(),
+                           std::make_move_iterator(from.order_flow.begin()),
+                           std::make_move_iterator(from.order_flow.end()));
+}
+
 static ConsumerStats consume_loop(
-    TradeQueue&            queue,
-    std::atomic<bool>&     keep_running,
-    std::chrono::seconds   duration)
+    TradeQueue&                       queue,
+    const std::atomic<bool>&          feed_running,
+    MarketSketches&                   sketches,
+    LiveDbSink*                       db_sink,
+    RollingParquetSink*               parquet_sink,
+    const JournalReader*              recovery,
+    const LiveDbSink::CommittedKeys*  committed,
+    size_t                            shard       = 0,
+    size_t                            shard_count = 1)
 {
     ConsumerStats stats;
 
-    auto deadline = std::chrono::steady_clock::now() + duration;
+    // Per-symbol running statistics live HERE, on the consumer thread.
+    // The filter is single-threaded and allocation-free after construction,
+    // so it adds O(1) work per tick without touching the producer's cache lines.
+    OutlierFilter<> outlier_filter;
+
+    // Streaming order flow: 1-second buckets (the demo only runs for 5 seconds).
+    OrderFlowAccumulator order_flow(1'000'000'000LL);
+
+    // Fixed-memory percentiles / distinct counts / heavy hitters — owned by
+    // the caller, which merges shards before taking the snapshot.
+
+    // Arrival order → per-symbol timestamp order. Everything below it (the
+    // outlier screen, bucketed order flow) sees ticks in event time.
+    TickReorderBuffer reorder;
+
+    // Runs for each tick the reorder buffer releases, in timestamp order.
+    auto process = [&](const Trade& t)
+    {
+        // Statistical screen: a print that passed the sanity check can still be
+        // 30% away from the last RELIANCE trade. Rejected prints never reach the
+        // per-symbol stats (or, in a full system, the live indicators).
+        if (outlier_filter.check(t) == OutlierVerdict::Reject)
+        {
+            ++stats.outliers;
+            return;
+        }
+
+        ++stats.valid;
+        stats.per_symbol[t.symbol]++;
+        order_flow.add(t);
+        sketches.update(t);
+        if (db_sink)
+            db_sink->offer(t);
+        if (parquet_sink)
+            parquet_sink->offer(t);
+    };
+
+    // Lightweight hot-path validation, then event-time ordering.
+    // NOT the full TradeValidator (regex is expensive in a hot loop).
+    // In production: validate on ingestion (client side), trust on consume side.
+    // Here: just a sanity check.
+    auto ingest = [&](Trade&& t)
+    {
+        if (!(t.price > 0.0 && t.volume > 0))
+        {
+            ++stats.rejected;
+            return;
+        }
+
+        // Too-late ticks are counted in reorder.stats() and dropped.
+        reorder.push(std::move(t), process);
+    };
+
+    // Crash recovery: ticks a previous run received but may not have
+    // persisted go through the same path as live ones, before them.
+    // Sharded: every shard reads the whole journal and keeps its own symbols.
+    // Ticks the crashed run already committed (committed) are not re-sent —
+    // trades_live has no key to absorb the duplicates.
+    if (recovery)
+    {
+        stats.recovery = recovery->replay([&](Trade t)
+                                          {
+                                              if (shard_count > 1 &&
+                                                  TickClient::shard_of(t.symbol, shard_count) != shard)
+                                                  return;
+                                              if (committed && committed->contains({t.trade_id, t.timestamp}))
+                                              {
+                                                  ++stats.recovery_skipped;
+                                                  return;
+                                              }
+                                              ingest(std::move(t)); });
+        reorder.flush(process); // recovered ticks are older than any live tick
+    }
+
+    // Event-time heartbeat: a symbol that stops trading never moves its own
+    // watermark, so its last ticks would sit in the reorder buffer until the
+    // end of the run. Every HEARTBEAT of wall time, advance every symbol to
+    // the newest timestamp seen on ANY symbol — and, if no newer tick came
+    // since the last beat (the feed is idle), let event time run on with the
+    // wall clock from there. The clock is read only when the queue is empty
+    // or once per HEARTBEAT_TICKS ticks, never per tick.
+    constexpr auto   HEARTBEAT       = std::chrono::milliseconds(10);
+    constexpr size_t HEARTBEAT_TICKS = 1024;
+    long long newest_ts      = std::numeric_limits<long long>::min();
+    long long anchor_ts      = newest_ts;                        // event time at the last beat ...
+    auto      anchor_at      = std::chrono::steady_clock::now(); // ... and when
+    auto      next_heartbeat = anchor_at + HEARTBEAT;
+    size_t    since_check    = 0;
+    auto heartbeat = [&](std::chrono::steady_clock::time_point now)
+    {
+        if (now < next_heartbeat || newest_ts == std::numeric_limits<long long>::min())
+            return;
+        if (newest_ts != anchor_ts)
+        {
+            anchor_ts = newest_ts;
+            anchor_at = now;
+        }
+        const long long idle_ns =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - anchor_at).count();
+        reorder.advance_to(anchor_ts + idle_ns, process);
+        next_heartbeat = now + HEARTBEAT;
+    };
 
-    while (std::chrono::steady_clock::now() < deadline || !queue.empty())
+    // Until the client has exited (feed_running cleared AFTER its last push)
+    // and everything it pushed is popped. Load the flag first: once it reads
+    // false, empty() is final.
+    while (feed_running.load(std::memory_order_acquire) || !queue.empty())
     {
         // try_pop() is non-blocking: returns Trade immediately or nullopt.
         // WHY NOT BLOCK? If we blocked on an empty queue, we'd burn CPU
@@ -97,33 +297,46 @@ static ConsumerStats consume_loop(
 
         if (!item)
         {
+            heartbeat(std::chrono::steady_clock::now());
             // Queue is empty — client might be mid-receive. Yield = polite wait.
             std::this_thread::yield();
             continue;
         }
 
         ++stats.total_consumed;
-
-        // Lightweight hot-path validation.
-        // NOT the full TradeValidator (regex is expensive in a hot loop).
-        // In production: validate on ingestion (client side), trust on consume side.
-        // Here: just a sanity check.
-        const Trade& t = *item;
-        if (t.price > 0.0 && t.volume > 0)
-        {
-            ++stats.valid;
-            stats.per_symbol[t.symbol]++;
-        }
-        else
+        newest_ts = std::max(newest_ts, item->timestamp);
+        ingest(std::move(*item));
+        if (++since_check == HEARTBEAT_TICKS)
         {
-            ++stats.rejected;
+            since_check = 0;
+            heartbeat(std::chrono::steady_clock::now());
         }
     }
 
-    keep_running.store(false, std::memory_order_release);
+    reorder.flush(process);
+    stats.reorder_stats = reorder.stats();
+    stats.outlier_stats = outlier_filter.stats();
+    stats.order_flow = order_flow.flush();
     return stats;
 }
 
+// ============================================================================
+// ConsumerShard — one queue and everything its consumer owns
+// ============================================================================
+// ETL_SHARDS=1: a single shard, run on main. Otherwise shard i runs on its
+// own thread, which constructs the queue itself (after pinning, so the ring
+// lands on its NUMA node) and waits for main's go signal.
+// ============================================================================
+struct ConsumerShard
+{
+    std::unique_ptr<TradeQueue>         queue;
+    std::unique_ptr<LiveDbSink>         db_sink;
+    std::unique_ptr<RollingParquetSink> parquet_sink;
+    MarketSketches                      sketches;
+    ConsumerStats                       stats;
+    std::thread                         thread;
+};
+
 // ============================================================================
 // main()
 // ============================================================================
@@ -135,11 +348,53 @@ int main()
 
     constexpr auto RUN_DURATION = std::chrono::seconds(5);
 
-    // ── Shared queue: client pushes, main pops ─────────────────────────────
-    // Declared here in main — both TickClient and consume_loop reference it.
-    // Lifetime: lives for the duration of main. Both threads finish before
-    // main returns (server.stop() + client.stop() join their threads first).
-    TradeQueue queue;
+    // ── Shards: ETL_SHARDS consumers, one queue each ───────────────────────
+    // Declared before the client: the queues must outlive its thread
+    // (client.stop() joins it before main returns).
+    const size_t shard_count = ThreadPlacement::shard_count();
+    std::vector<ConsumerShard> shards(shard_count);
+
+    // Read by the shard threads once go is set — declared before they start.
+    std::unique_ptr<JournalReader> recovery;
+    std::unique_ptr<TickJournal> journal;
+    LiveDbSink::CommittedKeys committed; // crash replay: already in trades_live
+    const LiveDbSink::CommittedKeys* committed_ptr = nullptr;
+    std::atomic<bool> feed_running{true};
+    std::atomic<size_t> ready{0};
+    std::atomic<bool> go{false};
+
+    if (shard_count == 1)
+    {
+        // ── Placement: main IS the consumer — pin it before the queue exists ─
+        // SPSCQueue's constructor writes every slot, so the ring's pages land on
+        // this thread's NUMA node (first touch). No-op unless ETL_CPU_PLAN is set.
+        ThreadPlacement::apply(ThreadRole::Consumer);
+        shards[0].queue = std::make_unique<TradeQueue>();
+    }
+    else
+    {
+        std::cout << "[MAIN] Sharding by symbol across " << shard_count << " consumers.\n";
+        for (size_t i = 0; i < shard_count; ++i)
+        {
+            shards[i].thread = std::thread([&, i]()
+            {
+                ConsumerShard& shard = shards[i];
+                ThreadPlacement::apply(ThreadRole::Consumer, i);
+                shard.queue = std::make_unique<TradeQueue>(); // first touch on this core
+                ready.fetch_add(1, std::memory_order_release);
+
+                // Sinks and the journal reader are set up by main meanwhile
+                while (!go.load(std::memory_order_acquire))
+                    std::this_thread::yield();
+
+                shard.stats = consume_loop(*shard.queue, feed_running, shard.sketches,
+                                           shard.db_sink.get(), shard.parquet_sink.get(),
+                                           recovery.get(), committed_ptr, i, shard_count);
+            });
+        }
+        while (ready.load(std::memory_order_acquire) < shard_count)
+            std::this_thread::yield();
+    }
 
     // ── Start server ───────────────────────────────────────────────────────
     // start() returns immediately. Server thread starts binding in background.
@@ -153,30 +408,209 @@ int main()
     // ── Start client ───────────────────────────────────────────────────────
     // Client connects, does WebSocket handshake, starts receive loop.
     // start() is fire-and-forget — client runs on its own thread.
-    TickClient client(queue, "localhost", "9002");
+    std::vector<TradeQueue*> queues;
+    for (auto& shard : shards)
+        queues.push_back(shard.queue.get());
+    TickClient client(std::move(queues), "localhost", "9002");
+
+    // ── Optional: write-ahead journal (ETL_JOURNAL_DIR set) ────────────────
+    // The reader snapshots segments left by a previous run BEFORE the new
+    // journal starts writing its own (numbered after them).
+    if (const char* env_journal = std::getenv("ETL_JOURNAL_DIR"))
+    {
+        try
+        {
+            recovery = std::make_unique<JournalReader>(env_journal);
+            if (recovery->empty())
+                recovery.reset();
+            else
+                std::cout << "[MAIN] Found " << recovery->segments().size()
+                          << " journal segment(s) from an unclean shutdown — replaying.\n";
+
+            TickJournalConfig journal_config;
+            journal_config.directory = env_journal;
+            journal = std::make_unique<TickJournal>(journal_config);
+            journal->start();
+            client.attach_journal(journal.get());
+            std::cout << "[MAIN] Journaling ticks to " << env_journal << "\n";
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "[MAIN] Tick journal disabled: " << e.what() << "\n";
+            journal.reset();
+        }
+    }
+
     client.start();
 
     // Small sleep to let client print its "Connected" message before
     // consumer output. Not required for correctness — just readability.
     std::this_thread::sleep_for(std::chrono::milliseconds(50));
 
-    // ── Run consumer on main thread ────────────────────────────────────────
+    // ── Optional: persist accepted ticks (ETL_DB_CONN set) ─────────────────
+    // Sinks are single-producer: each shard gets its own (own connection).
+    bool persisting = false;
+    if (const char* env_conn = std::getenv("ETL_DB_CONN"))
+    {
+        for (auto& shard : shards)
+        {
+            try
+            {
+                shard.db_sink = std::make_unique<LiveDbSink>(env_conn);
+                shard.db_sink->start();
+                persisting = true;
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "[MAIN] Live DB sink disabled: " << e.what() << "\n";
+                shard.db_sink.reset();
+            }
+        }
+        if (persisting)
+            std::cout << "[MAIN] Persisting ticks to trades_live.\n";
+    }
+
+    // ── Optional: rolling Parquet files (ETL_LIVE_PARQUET_DIR set) ──────────
+    bool writing_parquet = false;
+    if (const char* env_dir = std::getenv("ETL_LIVE_PARQUET_DIR"))
+    {
+        for (size_t i = 0; i < shard_count; ++i)
+        {
+            RollingParquetConfig parquet_config;
+            parquet_config.directory = env_dir;
+            if (shard_count > 1)
+                parquet_config.prefix += "_s" + std::to_string(i); // no name clashes
+            shards[i].parquet_sink = std::make_unique<RollingParquetSink>(parquet_config);
+            shards[i].parquet_sink->start();
+        }
+        writing_parquet = true;
+        std::cout << "[MAIN] Writing rolling Parquet files to " << env_dir << "\n";
+    }
+
+    // ── Recovery: which journaled ticks did the crashed run commit? ────────
+    // One pass over the journal for its time range, one COPY OUT of the keys
+    // trades_live holds in it. Shared read-only by every shard.
+    if (recovery && persisting)
+    {
+        long long lo = std::numeric_limits<long long>::max();
+        long long hi = std::numeric_limits<long long>::min();
+        recovery->replay_records([&](const JournalRecord& r)
+                                 {
+                                     lo = std::min<long long>(lo, r.timestamp);
+                                     hi = std::max<long long>(hi, r.timestamp); });
+        for (auto& shard : shards)
+        {
+            if (!shard.db_sink || lo > hi)
+                continue;
+            try
+            {
+                committed = shard.db_sink->committed_keys(lo, hi);
+                committed_ptr = &committed;
+                std::cout << "[MAIN] " << committed.size()
+                          << " journaled tick(s) already in trades_live — not replayed to it.\n";
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "[MAIN] Cannot read committed ticks, replaying all: " << e.what() << "\n";
+            }
+            break;
+        }
+    }
+
+    // ── Run consumer(s): main thread, or release the shard threads ─────────
     std::cout << "[MAIN] Running for " << RUN_DURATION.count() << " seconds...\n\n";
 
-    std::atomic<bool> keep_running{true};
     auto start_time = std::chrono::high_resolution_clock::now();
 
-    ConsumerStats stats = consume_loop(queue, keep_running, RUN_DURATION);
+    // ── Stop server and client at the deadline, THEN let consumers drain ──
+    // stop() sets running_=false and joins the thread.
+    // Order matters: stop server first → server sends CLOSE frame →
+    // client receives it → client exits cleanly → client.stop() joins immediately.
+    // feed_running is cleared only after the client's last push.
+    std::thread feed_timer([&]()
+    {
+        ThreadPlacement::apply(ThreadRole::Helper); // not main's consumer core
+        std::this_thread::sleep_for(RUN_DURATION);
+        server.stop();
+        client.stop();
+        feed_running.store(false, std::memory_order_release);
+    });
+
+    if (shard_count == 1)
+    {
+        ConsumerShard& shard = shards[0];
+        shard.stats = consume_loop(*shard.queue, feed_running, shard.sketches,
+                                   shard.db_sink.get(), shard.parquet_sink.get(),
+                                   recovery.get(), committed_ptr);
+    }
+    else
+    {
+        go.store(true, std::memory_order_release);
+        for (auto& shard : shards)
+            shard.thread.join();
+    }
+    feed_timer.join();
+    for (auto& shard : shards)
+    {
+        if (shard.db_sink)
+            shard.db_sink->stop(); // drains and commits the last batch
+        if (shard.parquet_sink)
+            shard.parquet_sink->stop(); // last row group, footer, rename
+    }
 
     auto end_time = std::chrono::high_resolution_clock::now();
     double elapsed_s = std::chrono::duration<double>(end_time - start_time).count();
 
-    // ── Stop server and client ─────────────────────────────────────────────
-    // stop() sets running_=false and joins the thread.
-    // Order matters: stop server first → server sends CLOSE frame →
-    // client receives it → client exits cleanly → client.stop() joins immediately.
-    server.stop();
-    client.stop();
+    // ── Merge shards: one set of stats, sinks and sketches for the report ──
+    std::vector<size_t> consumed_per_shard;
+    LiveSinkStats db;
+    RollingParquetStats pq;
+    for (auto& shard : shards)
+    {
+        consumed_per_shard.push_back(shard.stats.total_consumed);
+        if (shard.db_sink)
+        {
+            const LiveSinkStats& s = shard.db_sink->stats();
+            db.rows += s.rows;
+            db.batches += s.batches;
+            db.failed_rows += s.failed_rows;
+            db.p99_latency_ns = std::max(db.p99_latency_ns, s.p99_latency_ns); // worst shard
+            db.max_latency_ns = std::max(db.max_latency_ns, s.max_latency_ns);
+        }
+        if (shard.parquet_sink)
+        {
+            const RollingParquetStats s = shard.parquet_sink->stats();
+            pq.rows_written += s.rows_written;
+            pq.row_groups += s.row_groups;
+            pq.files_closed += s.files_closed;
+            pq.dropped += s.dropped;
+            pq.failed = pq.failed || s.failed;
+        }
+    }
+
+    ConsumerStats stats = std::move(shards[0].stats);
+    for (size_t i = 1; i < shard_count; ++i)
+    {
+        merge_into(stats, std::move(shards[i].stats));
+        shards[0].sketches.merge(shards[i].sketches);
+    }
+    stats.sketches = shards[0].sketches.snapshot();
+
+    // ── Journal: every tick is now in the sinks → the journal is redundant ──
+    // Stop AFTER the client (its last append), delete only if nothing failed:
+    // a lost DB batch leaves the journal for the next run to replay.
+    if (journal)
+    {
+        journal->stop();
+        // Dropped = journaled but never queued (shutdown with a full queue);
+        // a failed Parquet sink dropped ticks the journal still holds
+        const bool persisted = !journal->failed() && db.failed_rows == 0 && client.ticks_dropped() == 0 &&
+                               !pq.failed && pq.dropped == 0;
+        if (persisted)
+            JournalReader::remove_segments(journal->directory());
+        else
+            std::cerr << "[MAIN] Keeping journal in " << journal->directory().string() << " for replay.\n";
+    }
 
     // ── Print results ──────────────────────────────────────────────────────
     double throughput = static_cast<double>(stats.total_consumed) / elapsed_s;
@@ -197,10 +631,62 @@ int main()
               << "                        ║\n";
     std::cout << "║  Rejected              : " << std::setw(8) << stats.rejected
               << "                        ║\n";
+    std::cout << "║  Reordered (late <50ms): " << std::setw(8) << stats.reorder_stats.reordered
+              << "                        ║\n";
+    std::cout << "║  Dropped (too late)    : " << std::setw(8) << stats.reorder_stats.late
+              << "                        ║\n";
+    std::cout << "║  Outliers (k-sigma)    : " << std::setw(8) << stats.outliers
+              << "                        ║\n";
+    std::cout << "║  Regime reseeds        : " << std::setw(8) << stats.outlier_stats.reseeded
+              << "                        ║\n";
     std::cout << "║  Parse errors          : " << std::setw(8) << client.parse_errors()
               << "                        ║\n";
     std::cout << "║  Consumer throughput   : " << std::setw(8)
               << static_cast<size_t>(throughput) << " trades/sec             ║\n";
+    if (shard_count > 1)
+    {
+        // Routed vs consumed per shard: uneven counts = hash skew
+        for (size_t i = 0; i < shard_count; ++i)
+            std::cout << "║  Shard " << std::setw(2) << i << " routed / used: " << std::setw(8)
+                      << client.shard_ticks()[i] << " / " << std::setw(5) << consumed_per_shard[i]
+                      << "                ║\n";
+    }
+    if (persisting)
+    {
+        std::cout << "║  Persisted (trades_live): " << std::setw(7) << db.rows
+                  << "                        ║\n";
+        std::cout << "║  DB batches            : " << std::setw(8) << db.batches
+                  << "                        ║\n";
+        std::cout << "║  Persist p99 / max     : " << std::setw(4) << db.p99_latency_ns / 1'000'000
+                  << " / " << std::setw(4) << db.max_latency_ns / 1'000'000 << " ms                   ║\n";
+    }
+    if (journal)
+    {
+        const TickJournalStats& js = journal->stats();
+        std::cout << "║  Journaled ticks       : " << std::setw(8) << js.records
+                  << "                        ║\n";
+        std::cout << "║  Journal blocks / syncs: " << std::setw(8) << js.blocks
+                  << " / " << std::setw(5) << js.syncs << "                ║\n";
+    }
+    if (recovery)
+    {
+        std::cout << "║  Recovered (replayed)  : " << std::setw(8) << stats.recovery.records
+                  << "                        ║\n";
+        std::cout << "║  Corrupt blocks skipped: " << std::setw(8) << stats.recovery.corrupt_blocks
+                  << "                        ║\n";
+        std::cout << "║  Already committed     : " << std::setw(8) << stats.recovery_skipped
+                  << "                        ║\n";
+    }
+    if (writing_parquet)
+    {
+        std::cout << "║  Parquet rows / groups : " << std::setw(8) << pq.rows_written
+                  << " / " << std::setw(5) << pq.row_groups << "                ║\n";
+        std::cout << "║  Parquet files closed  : " << std::setw(8) << pq.files_closed
+                  << "                        ║\n";
+        if (pq.failed)
+            std::cout << "║  Parquet FAILED, drop  : " << std::setw(8) << pq.dropped
+                      << "                        ║\n";
+    }
     std::cout << "╠══════════════════════════════════════════════════════╣\n";
     std::cout << "║  Per-symbol breakdown:                               ║\n";
 
@@ -211,7 +697,10 @@ int main()
                   << "                       ║\n";
     }
 
-    std::cout << "╚══════════════════════════════════════════════════════╝\n\n";
+    std::cout << "╚══════════════════════════════════════════════════════╝\n";
+
+    OrderFlowAnalyzer::print_summary(stats.order_flow);
+    MarketSketches::print_snapshot(stats.sketches);
 
     std::cout << "[SUCCESS] Phase 14 complete. Real-time WebSocket feed operational.\n";
     std::cout << "===================================================\n";
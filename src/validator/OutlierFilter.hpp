@@ -0,0 +1,266 @@
+#pragma once
+
+// ============================================================================
+// OutlierFilter — Stateful, per-symbol statistical price validation
+// ============================================================================
+//
+// WHY TradeValidator IS NOT ENOUGH ON A LIVE FEED
+// ─────────────────────────────────────────────────────────────────────────────
+// TradeValidator::validate() is STATELESS: it looks at one trade in isolation.
+// A RELIANCE print at ₹3,200 passes every rule (0 < price < 1,000,000) even if
+// the previous RELIANCE print was ₹2,457 — a 30% jump in 10 microseconds.
+// That is a bad print (fat finger, feed glitch, wrong instrument), and once it
+// reaches the live SMA/RSI/VWAP it poisons them for the next N ticks.
+//
+// To catch it we need MEMORY: "what does a normal move look like for THIS symbol?"
+//
+// THE MODEL: EWMA of log returns
+// ─────────────────────────────────────────────────────────────────────────────
+// For every accepted tick we compute the log return vs the last accepted print:
+//     r = ln(price / last_price)
+// and keep an exponentially weighted mean and variance of r:
+//     mean ← mean + α·(r − mean)
+//     var  ← (1 − α)·(var + α·(r − mean_old)²)
+// A new tick is rejected when it lies more than k standard deviations away:
+//     |r − mean| > k · max(σ, min_sigma)
+//
+// WHY LOG RETURNS AND NOT RAW PRICES?
+// A ₹5 move means nothing on BAJFINANCE (₹6,800) and a lot on WIPRO (₹430).
+// Log returns are scale-free — one k works for every symbol.
+//
+// WHY EWMA AND NOT A ROLLING WINDOW?
+// EWMA needs THREE doubles of state per symbol and O(1) work per tick.
+// A rolling median of N prints needs an N-slot buffer and a selection step.
+// Same protective effect for our purpose, a fraction of the state.
+//
+// WHY min_sigma?
+// A symbol that printed the same price 20 times has σ = 0. Without a floor,
+// the next 1-paisa tick would be "infinitely many sigmas" away and rejected.
+// min_sigma (default 1 basis point) is the smallest move we treat as normal noise.
+//
+// REGIME CHANGES
+// ─────────────────────────────────────────────────────────────────────────────
+// Sometimes the market really does gap (news, circuit breaker release).
+// Rejecting forever would freeze the symbol at a stale price. So after
+// `reseed_after` CONSECUTIVE rejections we accept the print as the new level.
+// One bad print is rejected. A new price level that persists is adopted.
+//
+// HOT-PATH GUARANTEES
+// ─────────────────────────────────────────────────────────────────────────────
+//   • O(1) per tick: one hash probe + a handful of floating point ops.
+//   • ZERO allocations after construction: per-symbol state lives in a
+//     fixed-capacity open-addressing table stored inline (std::array).
+//   • Single-threaded by design: owned by the SPSCQueue consumer thread,
+//     exactly like the queue's consumer side. No atomics, no locks.
+// ============================================================================
+
+#include <array>
+#include <bit>     // std::countr_zero — log2 of a power of 2
+#include <cmath>   // std::log, std::sqrt, std::fabs
+#include <cstdint>
+#include <cstddef>
+#include "../model/Trade.hpp"
+#include "../model/SymbolKey.hpp"
+
+namespace MarketStream
+{
+
+    // ============================================================================
+    // OutlierVerdict — what the filter decided for one tick
+    // ============================================================================
+    enum class OutlierVerdict : uint8_t
+    {
+        Accept,    // Within k sigma — safe to feed indicators
+        Warmup,    // Not enough history yet — accepted, but statistics still forming
+        Reseed,    // Rejected too many times in a row — accepted as a new price level
+        Reject,    // Beyond k sigma — do NOT feed indicators
+        Untracked  // Symbol table full — accepted without a check (see capacity)
+    };
+
+    // ============================================================================
+    // OutlierConfig — tuning knobs (defaults tuned for NSE equities tick data)
+    // ============================================================================
+    struct OutlierConfig
+    {
+        double k_sigma = 6.0;       // Rejection threshold in standard deviations
+        double alpha = 0.05;        // EWMA weight of the newest return (~20-tick memory)
+        uint32_t warmup_ticks = 20; // Accept unconditionally until this many returns are seen
+        double min_sigma = 1e-4;    // σ floor: 1 basis point in log-return terms
+        uint32_t reseed_after = 5;  // Consecutive rejects before adopting the new level
+    };
+
+    // ============================================================================
+    // OutlierStats — running counters (read by the report at shutdown)
+    // ============================================================================
+    struct OutlierStats
+    {
+        size_t accepted = 0;
+        size_t warmup = 0;
+        size_t reseeded = 0;
+        size_t rejected = 0;
+        size_t untracked = 0;
+    };
+
+    // ============================================================================
+    // OutlierFilter<MaxSymbols>
+    // ============================================================================
+    // TEMPLATE PARAMETER:
+    //   MaxSymbols — capacity of the inline symbol table. MUST be a power of 2
+    //                (same reason as SPSCQueue: index & MASK instead of %).
+    //                The table is kept at most 50% full for short probe chains,
+    //                so MaxSymbols = 1024 tracks up to 512 distinct symbols.
+    //
+    // USAGE (consumer thread):
+    //   OutlierFilter<> filter;
+    //   if (auto item = queue.try_pop()) {
+    //       if (filter.check(*item) != OutlierVerdict::Reject)
+    //           update_live_indicators(*item);
+    //   }
+    // ============================================================================
+    template <size_t MaxSymbols = 1024>
+    class OutlierFilter
+    {
+        static_assert((MaxSymbols & (MaxSymbols - 1)) == 0,
+                      "OutlierFilter capacity must be a power of 2");
+        static_assert(MaxSymbols >= 2, "OutlierFilter capacity must be at least 2");
+
+    public:
+        explicit OutlierFilter(OutlierConfig config = {})
+            : config_(config)
+        {
+        }
+
+        // ========================================================================
+        // check() — classify one tick and update the symbol's statistics
+        // ========================================================================
+        // Rejected prints do NOT update mean/var/last_price. That is the whole
+        // point: the bad print never becomes part of the baseline it is judged by.
+        // ========================================================================
+        [[nodiscard]]
+        OutlierVerdict check(const Trade &trade)
+        {
+            SymbolState *s = find_or_insert(SymbolKey::from(trade.symbol));
+            if (!s)
+            {
+                ++stats_.untracked;
+                return OutlierVerdict::Untracked;
+            }
+
+            // First print for this symbol: nothing to compare against yet.
+            if (s->samples == 0 && s->last_price <= 0.0)
+            {
+                s->last_price = trade.price;
+                ++stats_.warmup;
+                return OutlierVerdict::Warmup;
+            }
+
+            const double r = std::log(trade.price / s->last_price);
+
+            if (s->samples < config_.warmup_ticks)
+            {
+                accept(*s, trade.price, r);
+                ++stats_.warmup;
+                return OutlierVerdict::Warmup;
+            }
+
+            double sigma = std::sqrt(s->var);
+            if (sigma < config_.min_sigma)
+                sigma = config_.min_sigma;
+
+            if (std::fabs(r - s->mean) <= config_.k_sigma * sigma)
+            {
+                accept(*s, trade.price, r);
+                ++stats_.accepted;
+                return OutlierVerdict::Accept;
+            }
+
+            // Beyond k sigma. Reject — unless the "outlier" has become the market.
+            if (++s->consecutive_rejects >= config_.reseed_after)
+            {
+                // Adopt the new level WITHOUT feeding the gap into var:
+                // one regime jump should not inflate σ for the next 100 ticks.
+                s->last_price = trade.price;
+                s->consecutive_rejects = 0;
+                ++stats_.reseeded;
+                return OutlierVerdict::Reseed;
+            }
+
+            ++stats_.rejected;
+            return OutlierVerdict::Reject;
+        }
+
+        [[nodiscard]]
+        const OutlierStats &stats() const { return stats_; }
+
+        [[nodiscard]]
+        size_t tracked_symbols() const { return used_; }
+
+        static constexpr size_t capacity() { return MaxSymbols / 2; }
+
+    private:
+        // One slot per symbol. 48 bytes — ~1 slot per cache line pair.
+        struct SymbolState
+        {
+            SymbolKey key;                    // empty() key = free slot
+            double last_price = 0.0;          // Last ACCEPTED print
+            double mean = 0.0;                // EWMA of log returns
+            double var = 0.0;                 // EWMA variance of log returns
+            uint32_t samples = 0;             // Returns folded into mean/var
+            uint32_t consecutive_rejects = 0; // Reset on every accept
+        };
+
+        void accept(SymbolState &s, double price, double r)
+        {
+            // West's incremental EWMA update — numerically stable, no history.
+            const double a = config_.alpha;
+            const double diff = r - s.mean;
+            s.mean += a * diff;
+            s.var = (1.0 - a) * (s.var + a * diff * diff);
+            s.last_price = price;
+            s.consecutive_rejects = 0;
+            ++s.samples;
+        }
+
+        // ========================================================================
+        // find_or_insert() — open addressing with linear probing
+        // ========================================================================
+        // WHY LINEAR PROBING?
+        // Consecutive slots are adjacent in memory. A probe that misses its
+        // first slot usually finds the answer on the same or next cache line.
+        // With the table capped at 50% load, the expected probe length is ~1.5.
+        //
+        // Returns nullptr only when the 50% load cap is reached and the symbol
+        // is new — the caller counts it as Untracked instead of allocating.
+        // ========================================================================
+        SymbolState *find_or_insert(const SymbolKey &key)
+        {
+            size_t idx = static_cast<size_t>(key.hash() >> SHIFT);
+            while (true)
+            {
+                SymbolState &slot = slots_[idx];
+                if (slot.key == key)
+                    return &slot;
+                if (slot.key.empty())
+                {
+                    if (used_ >= capacity())
+                        return nullptr;
+                    slot.key = key;
+                    ++used_;
+                    return &slot;
+                }
+                idx = (idx + 1) & MASK;
+            }
+        }
+
+        static constexpr size_t MASK = MaxSymbols - 1;
+
+        // Use the TOP log2(MaxSymbols) bits of the hash as the home slot.
+        static constexpr unsigned SHIFT = 64 - std::countr_zero(MaxSymbols);
+
+        OutlierConfig config_;
+        OutlierStats stats_;
+        size_t used_ = 0;
+        std::array<SymbolState, MaxSymbols> slots_{};
+    };
+
+} // namespace MarketStream